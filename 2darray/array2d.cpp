@@ -4,19 +4,720 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+
+// Optional instrumentation (see `array2d_instrument.hpp`): define `YELLE_ARRAY2D_INSTRUMENT` before including this file to count calls, time, allocations, and element copies/moves per method.
+// When it isn't defined, both macros expand to nothing, so there is no cost at all.
+#ifdef YELLE_ARRAY2D_INSTRUMENT
+#include "array2d_instrument.hpp"
+#define YELLE_ARRAY2D_OP(name) \
+    static ::yelle::instrument::OpStats& yelle_op_stats = ::yelle::instrument::op_stats("Array2D::" name); \
+    const ::yelle::instrument::ScopedOp yelle_scoped_op(yelle_op_stats)
+#define YELLE_ARRAY2D_ELEMENTS(copies, moves) ::yelle::instrument::count_elements((copies), (moves))
+#else
+#define YELLE_ARRAY2D_OP(name) ((void)0)
+#define YELLE_ARRAY2D_ELEMENTS(copies, moves) ((void)0)
+#endif
 
 namespace yelle {
 
 enum class iterator_direction { FORWARD, REVERSED };
 
+// Which neighbours of a cell count as adjacent when treating an array as a grid graph: the 4 sharing an edge, or all 8 including the diagonals.
+enum class connectivity { FOUR, EIGHT };
+
+// Arithmetic modulo the Mersenne prime `2^61 - 1`, for polynomial hashes over an array: the cell at `[i,j]` is weighed by `BASE_I^i * BASE_J^j`.
+namespace hash61 {
+
+constexpr uint64_t MOD = (uint64_t(1) << 61) - 1;
+constexpr uint64_t BASE_I = 0x0e7037ed1a0b428d;
+constexpr uint64_t BASE_J = 0x1b873593a3c5ea71;
+
+// `x mod (2^61 - 1)`, for any `x`.
+inline uint64_t reduce(const uint64_t x) {
+    const uint64_t folded = (x & MOD) + (x >> 61);
+    return (folded >= MOD ? folded - MOD : folded);
+}
+
+// `(a * b) mod (2^61 - 1)`, for `a, b < 2^61`.
+inline uint64_t mul(const uint64_t a, const uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 wide;
+    const wide product = static_cast<wide>(a) * b;
+    const uint64_t x = (static_cast<uint64_t>(product) & MOD) + static_cast<uint64_t>(product >> 61);
+    return (x >= MOD ? x - MOD : x);
+#else
+    const uint64_t low31 = (uint64_t(1) << 31) - 1;
+    const uint64_t a_hi = a >> 31, a_lo = a & low31;
+    const uint64_t b_hi = b >> 31, b_lo = b & low31;
+    // `a*b = a_hi*b_hi*2^62 + mid*2^31 + a_lo*b_lo`, where `2^61 = 1` (mod `2^61 - 1`)
+    const uint64_t mid = a_hi * b_lo + a_lo * b_hi;
+    uint64_t x = (a_hi * b_hi << 1) + (mid >> 30) + ((mid & ((uint64_t(1) << 30) - 1)) << 31) + a_lo * b_lo;
+    x = (x & MOD) + (x >> 61);
+    x = (x & MOD) + (x >> 61);
+    return (x >= MOD ? x - MOD : x);
+#endif
+}
+
+inline uint64_t add(const uint64_t a, const uint64_t b) {
+    const uint64_t x = a + b;
+    return (x >= MOD ? x - MOD : x);
+}
+
+inline uint64_t sub(const uint64_t a, const uint64_t b) {
+    return (a >= b ? a - b : a + MOD - b);
+}
+
+inline uint64_t pow(uint64_t base, uint64_t exp) {
+    uint64_t result = 1;
+    for (; exp > 0; exp >>= 1) {
+        if (exp & 1) {
+            result = mul(result, base);
+        }
+        base = mul(base, base);
+    }
+    return result;
+}
+
+// Multiplicative inverse of `a != 0`.
+inline uint64_t inverse(const uint64_t a) {
+    return pow(a, MOD - 2);
+}
+
+// Scrambles all 64 bits of `x` (the splitmix64 finalizer), so that e.g. small consecutive integers hash to unrelated values.
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash of one element, by `std::hash<T>` if there is one; otherwise every element hashes alike.
+template <class T>
+uint64_t element(const T& value) {
+    if constexpr (std::is_default_constructible<std::hash<T>>::value) {
+        return reduce(static_cast<uint64_t>(std::hash<T>()(value)));
+    } else {
+        return 0;
+    }
+}
+
+};  // end namespace hash61
+
 template <class T>
 class Array2D {
 protected:
+    // Arrays of other element types, so that e.g. `map_into` can write straight into its output's storage.
+    template <class> friend class Array2D;
+
     // Holds the data of the 2D array.
     std::vector<std::vector<T>> array;
 
+    // Logical origin of the array within `array`, for O(1) cyclic shifting: the element at logical `[i,j]` is stored at `array[(i + row_origin) % rowCount()][(j + col_origin) % colCount()]`.
+    // Methods that rearrange the rows/columns themselves call `normalize_origin()` first, so that they can work on `array` directly.
+    size_t row_origin = 0;
+    size_t col_origin = 0;
+
+    // Column capacity that every row is given, so that columns can be appended without each row reallocating on its own schedule.
+    // Set by `reserve`, and grown geometrically whenever a column is added beyond it.
+    size_t reserved_cols = 0;
+
+    // Physical row index of logical row `i`, for `i < rowCount()`.
+    size_t phys_row(const size_t i) const {
+        const size_t k = i + row_origin;
+        return (k >= array.size() ? k - array.size() : k);
+    }
+
+    // Physical column index of logical column `j`, for `j < colCount()`.
+    size_t phys_col(const size_t j) const {
+        const size_t cct = colCount();
+        const size_t k = j + col_origin;
+        return (k >= cct ? k - cct : k);
+    }
+
+    // Pointer to the element at logical `[i,j]`, or `nullptr` if `[i,j]` is out of range.
+    T* cell_ptr(const long i, const long j) const {
+        if (i < 0 || j < 0 || static_cast<size_t>(i) >= rowCount() || static_cast<size_t>(j) >= colCount()) {
+            return nullptr;
+        }
+        return const_cast<T*>(&(array[phys_row(i)][phys_col(j)]));
+    }
+
+    // Rotates `row` left by `k` places, so that `row[k]` becomes `row[0]`.
+    // For trivially copyable `T` this is three bulk copies, with the shorter side parked in `buffer`, rather than `std::rotate`'s element-by-element swaps.
+    static void rotate_row(std::vector<T>& row, const size_t k, std::vector<unsigned char>& buffer) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            T* const data = row.data();
+            const size_t n = row.size();
+            if (k <= n - k) {
+                buffer.resize(k * sizeof(T));
+                std::memcpy(buffer.data(), data, k * sizeof(T));
+                std::memmove(data, data + k, (n - k) * sizeof(T));
+                std::memcpy(data + (n - k), buffer.data(), k * sizeof(T));
+            } else {
+                buffer.resize((n - k) * sizeof(T));
+                std::memcpy(buffer.data(), data + k, (n - k) * sizeof(T));
+                std::memmove(data + (n - k), data, k * sizeof(T));
+                std::memcpy(data, buffer.data(), (n - k) * sizeof(T));
+            }
+        } else {
+            std::rotate(row.begin(), row.begin() + static_cast<long>(k), row.end());
+        }
+    }
+
+    // Physically rotates the stored rows and columns so that the logical origin is back at `[0,0]`. Costs O(size()) if a shift is pending, and nothing otherwise.
+    void normalize_origin() {
+        if (col_origin != 0) {
+            YELLE_ARRAY2D_ELEMENTS(0, size());
+            std::vector<unsigned char> buffer;
+            for (std::vector<T>& row : array) {
+                rotate_row(row, col_origin, buffer);
+            }
+            col_origin = 0;
+        }
+        if (row_origin != 0) {
+            std::rotate(array.begin(), array.begin() + static_cast<long>(row_origin), array.end());
+            row_origin = 0;
+        }
+    }
+
+    // Makes this array `row_ct` x `col_ct`, for an `_into` method that is about to overwrite every element.
+    // Returns `true` if it already had that shape, so that the elements can simply be assigned (keeping any logical origin). Otherwise the origin is reset and the rows are emptied, keeping their capacity, ready to be refilled with `push_back`.
+    bool prepare_into(const size_t row_ct, const size_t col_ct) {
+        if (rowCount() == row_ct && colCount() == col_ct) {
+            return true;
+        }
+        row_origin = 0;
+        col_origin = 0;
+        array.resize(row_ct);
+        for (std::vector<T>& row : array) {
+            row.clear();
+            row.reserve(std::max(reserved_cols, col_ct));
+        }
+        return false;
+    }
+
+    // Boilerplate code for `map_into` and the unary `_into` operators: sets each element of `out` to `func` of the corresponding element of this array.
+    // `out` may be this array itself.
+    template <class S, class Func>
+    Array2D<S>& impl_map_into(Array2D<S>& out, const Func& func) const {
+        const size_t row_ct = rowCount();
+        const size_t col_ct = colCount();
+        const bool same_shape = out.prepare_into(row_ct, col_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            const std::vector<T>& thisRow = array[phys_row(i)];
+            std::vector<S>& outRow = out.array[out.phys_row(i)];
+            if (!same_shape) {
+                for (size_t j=0; j < col_ct; ++j) {
+                    outRow.push_back(func(thisRow[phys_col(j)]));
+                }
+            } else if (col_origin == 0 && out.col_origin == 0) {
+                // common case: no column shift pending, so this is a plain loop over contiguous rows
+                for (size_t j=0; j < col_ct; ++j) {
+                    outRow[j] = func(thisRow[j]);
+                }
+            } else {
+                for (size_t j=0; j < col_ct; ++j) {
+                    outRow[out.phys_col(j)] = func(thisRow[phys_col(j)]);
+                }
+            }
+        }
+        return out;
+    }
+
+    // Dimension of the result of combining a dimension of `a` with one of `b` element-wise, broadcasting as in NumPy: they must match, or one of them must be 1 (which is then stretched to fit the other).
+    // Returns `std::nullopt` if they can't be combined.
+    static std::optional<size_t> broadcast_dim(const size_t a, const size_t b) {
+        if (a == b || b == 1) {
+            return a;
+        }
+        if (a == 1) {
+            return b;
+        }
+        return std::nullopt;
+    }
+
+    // Boilerplate code for `map2_into` and the binary `_into` operators: sets each element of `out` to `func` of the corresponding elements of this array and `other`.
+    // The two arrays must have dimensions that `broadcast_dim` accepts; a `1 x C` row, an `R x 1` column, or a `1 x 1` array is stretched across the other array without being copied.
+    // `out` may be either input.
+    template <class S, class T2, class Func>
+    Array2D<S>& impl_map2_into(Array2D<S>& out, const Func& func, const Array2D<T2>& other) const {
+        const size_t row_ct = *broadcast_dim(rowCount(), other.rowCount());
+        const size_t col_ct = *broadcast_dim(colCount(), other.colCount());
+        if (!(out.rowCount() == row_ct && out.colCount() == col_ct)
+            && (static_cast<const void*>(&out) == static_cast<const void*>(this) || static_cast<const void*>(&out) == static_cast<const void*>(&other))) {
+            // `out` is an input that is being stretched, so reshaping it now would lose its elements
+            Array2D<S> temp;
+            impl_map2_into(temp, func, other);
+            out = std::move(temp);
+            return out;
+        }
+        const bool same_shape = out.prepare_into(row_ct, col_ct);
+        const bool this_rows = (rowCount() == row_ct);
+        const bool other_rows = (other.rowCount() == row_ct);
+        const bool this_cols = (colCount() == col_ct);
+        const bool other_cols = (other.colCount() == col_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            const std::vector<T>& thisRow = array[phys_row(this_rows ? i : 0)];
+            const std::vector<T2>& otherRow = other.array[other.phys_row(other_rows ? i : 0)];
+            std::vector<S>& outRow = out.array[out.phys_row(i)];
+            if (!same_shape) {
+                for (size_t j=0; j < col_ct; ++j) {
+                    outRow.push_back(func(thisRow[this_cols ? phys_col(j) : 0], otherRow[other_cols ? other.phys_col(j) : 0]));
+                }
+            } else if (col_origin == 0 && other.col_origin == 0 && out.col_origin == 0) {
+                // common case: no column shift pending, so each of these is a plain loop over contiguous rows (a stretched column is read once per row, not per element)
+                if (!this_cols) {
+                    const T value = thisRow[0];
+                    for (size_t j=0; j < col_ct; ++j) {
+                        outRow[j] = func(value, otherRow[j]);
+                    }
+                } else if (!other_cols) {
+                    const T2 value = otherRow[0];
+                    for (size_t j=0; j < col_ct; ++j) {
+                        outRow[j] = func(thisRow[j], value);
+                    }
+                } else {
+                    for (size_t j=0; j < col_ct; ++j) {
+                        outRow[j] = func(thisRow[j], otherRow[j]);
+                    }
+                }
+            } else {
+                for (size_t j=0; j < col_ct; ++j) {
+                    outRow[out.phys_col(j)] = func(thisRow[this_cols ? phys_col(j) : 0], otherRow[other_cols ? other.phys_col(j) : 0]);
+                }
+            }
+        }
+        return out;
+    }
+
+    // Returns a new row holding a copy of `[first, last)`, with room for at least `reserved_cols` elements.
+    template <class Iter>
+    std::vector<T> reserved_copy(const Iter first, const Iter last) const {
+        std::vector<T> row;
+        row.reserve(std::max<size_t>(reserved_cols, static_cast<size_t>(std::distance(first, last))));
+        row.insert(row.end(), first, last);
+        YELLE_ARRAY2D_ELEMENTS(row.size(), 0);
+        return row;
+    }
+
+    // Returns a new row of `count` copies of `value`, with room for at least `reserved_cols` elements.
+    std::vector<T> reserved_fill(const size_t count, const T& value) const {
+        std::vector<T> row;
+        row.reserve(std::max(reserved_cols, count));
+        row.assign(count, value);
+        YELLE_ARRAY2D_ELEMENTS(count, 0);
+        return row;
+    }
+
+    // Gives `row` room for at least `reserved_cols` elements.
+    void reserve_row(std::vector<T>& row) const {
+        if (row.capacity() < reserved_cols) {
+            YELLE_ARRAY2D_ELEMENTS(0, row.size());
+            row.reserve(reserved_cols);
+        }
+    }
+
+    // Makes room for `needed` columns in every row, growing the shared column capacity geometrically so that adding columns one at a time only reallocates the rows O(log n) times, all at once.
+    void grow_cols(const size_t needed) {
+        if (needed > reserved_cols) {
+            reserved_cols = std::max(needed, 2 * reserved_cols);
+        }
+        for (std::vector<T>& row : array) {
+            reserve_row(row);
+        }
+    }
+
+    // Rearranges the array into a `new_max_i` x `new_max_j` shape, keeping elements in `begin()`...`end()` order.
+    // Elements that don't fit are dropped, and cells left over are filled with `*pad` (which may only be `nullptr` if the area doesn't grow).
+    // Each kept element is moved exactly once, in contiguous runs between rows; the first row's storage is reused for the new first row, so e.g. a `1 x N` array reshaped to `R x C` keeps its first `C` elements in place.
+    void reflow(const size_t new_max_i, const size_t new_max_j, const T* pad) {
+        normalize_origin();
+        const size_t old_max_i = rowCount();
+        const size_t old_max_j = colCount();
+        if (new_max_i == old_max_i && new_max_j == old_max_j) {
+            return;
+        }
+        if (new_max_i * new_max_j == 0) {
+            array.clear();
+            return;
+        }
+        if (old_max_i * old_max_j == 0) {
+            fill(new_max_i, new_max_j, *pad);
+            return;
+        }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            reflow_trivial(new_max_i, new_max_j, pad);
+            return;
+        }
+
+        std::vector<std::vector<T>> old;
+        old.swap(array);
+        array.reserve(new_max_i);
+
+        // next element of `old` to be moved
+        size_t src_i = 0;
+        size_t src_j = 0;
+        // moves up to `count` elements from the `old` cursor onto the end of `dst`, a whole run at a time
+        auto pull = [&](std::vector<T>& dst, size_t count) {
+            while (count > 0 && src_i < old_max_i) {
+                std::vector<T>& src = old[src_i];
+                const size_t run = std::min(count, old_max_j - src_j);
+                dst.insert(dst.end(), std::make_move_iterator(src.begin() + src_j), std::make_move_iterator(src.begin() + src_j + run));
+                YELLE_ARRAY2D_ELEMENTS(0, run);
+                src_j += run;
+                count -= run;
+                if (src_j == old_max_j) {
+                    ++src_i;
+                    src_j = 0;
+                }
+            }
+        };
+        // pads `dst` out to `new_max_j` elements
+        auto pad_out = [&](std::vector<T>& dst) {
+            if (dst.size() < new_max_j) {
+                dst.insert(dst.end(), new_max_j - dst.size(), *pad);
+            }
+        };
+
+        // The first new row is the first old row's storage. If it's shrinking, the rest of the new rows take their first elements from its tail before it's trimmed.
+        const bool first_row_shrinks = (new_max_j <= old_max_j);
+        array.emplace_back();
+        if (first_row_shrinks) {
+            src_j = new_max_j;
+            if (src_j == old_max_j) {
+                ++src_i;
+                src_j = 0;
+            }
+        } else {
+            array[0] = std::move(old[0]);
+            array[0].reserve(std::max(reserved_cols, new_max_j));
+            src_i = 1;
+            pull(array[0], new_max_j - old_max_j);
+            pad_out(array[0]);
+        }
+        for (size_t i=1; i < new_max_i; ++i) {
+            array.emplace_back();
+            array[i].reserve(std::max(reserved_cols, new_max_j));
+            pull(array[i], new_max_j);
+            pad_out(array[i]);
+        }
+        if (first_row_shrinks) {
+            array[0] = std::move(old[0]);
+            array[0].erase(array[0].begin() + new_max_j, array[0].end());
+        }
+    }
+
+    // `reflow` for trivially copyable `T`, done in place: each new row is rebuilt in the storage of the old row with the same index, so the only allocations are for rows that have to grow.
+    // If the rows widen, every element moves to the same or an earlier row, so the rows are rebuilt top to bottom; if they narrow, to the same or a later row, so bottom to top. Either way a row's own surviving elements slide over with one `memmove`, and the rest are bulk-copied in from rows not yet rebuilt.
+    void reflow_trivial(const size_t new_max_i, const size_t new_max_j, const T* pad) {
+        const size_t old_max_i = rowCount();
+        const size_t old_max_j = colCount();
+        const size_t kept = std::min(old_max_i * old_max_j, new_max_i * new_max_j);
+        YELLE_ARRAY2D_ELEMENTS(0, kept);
+        // `*pad` may be one of this array's own elements
+        std::optional<T> filler;
+        if (pad != nullptr) {
+            filler = *pad;
+        }
+
+        // appends the elements at flat indices `[f, f_past_end)` (in `begin()`...`end()` order) onto `dst`, a whole source run at a time
+        auto append = [&](std::vector<T>& dst, size_t f, const size_t f_past_end) {
+            while (f < f_past_end) {
+                const std::vector<T>& src = array[f / old_max_j];
+                const size_t off = f % old_max_j;
+                const size_t run = std::min(old_max_j - off, f_past_end - f);
+                dst.insert(dst.end(), src.begin() + static_cast<long>(off), src.begin() + static_cast<long>(off + run));
+                f += run;
+            }
+        };
+        auto make_room = [&](std::vector<T>& row) {
+            if (row.capacity() < new_max_j) {
+                row.reserve(std::max(reserved_cols, new_max_j));
+            }
+        };
+        auto pad_out = [&](std::vector<T>& row) {
+            if (row.size() < new_max_j) {
+                YELLE_ARRAY2D_ELEMENTS(new_max_j - row.size(), 0);
+                row.insert(row.end(), new_max_j - row.size(), *filler);
+            }
+        };
+
+        if (new_max_j >= old_max_j) {
+            if (new_max_i > old_max_i) {
+                array.resize(new_max_i);
+            }
+            for (size_t r=0; r < new_max_i; ++r) {
+                std::vector<T>& row = array[r];
+                const size_t lo = std::min(r * new_max_j, kept);
+                const size_t hi = std::min(lo + new_max_j, kept);
+                const size_t own_start = r * old_max_j;
+                size_t f = lo;
+                if (r < old_max_i && own_start <= lo && lo < own_start + old_max_j) {
+                    // keep the part of old row `r` that starts new row `r`
+                    const size_t own_past_end = std::min(hi, own_start + old_max_j);
+                    row.erase(row.begin() + static_cast<long>(own_past_end - own_start), row.end());
+                    row.erase(row.begin(), row.begin() + static_cast<long>(lo - own_start));
+                    f = own_past_end;
+                } else {
+                    row.clear();
+                }
+                make_room(row);
+                append(row, f, hi);
+                pad_out(row);
+            }
+            // rows past the end were still being read from until now
+            array.resize(new_max_i);
+        } else {
+            // rows past the end hold only dropped elements
+            array.resize(new_max_i);
+            for (size_t r = new_max_i; r-- > 0; ) {
+                std::vector<T>& row = array[r];
+                const size_t lo = std::min(r * new_max_j, kept);
+                const size_t hi = std::min(lo + new_max_j, kept);
+                const size_t own_start = r * old_max_j;
+                if (r < old_max_i && own_start < hi) {
+                    // keep the part of old row `r` that ends new row `r`, then put the rest in front of it, last piece first
+                    row.erase(row.begin() + static_cast<long>(hi - own_start), row.end());
+                    make_room(row);
+                    size_t f = own_start;
+                    while (f > lo) {
+                        const size_t s = (f - 1) / old_max_j;
+                        const size_t piece_start = std::max(lo, s * old_max_j);
+                        const std::vector<T>& src = array[s];
+                        row.insert(row.begin(), src.begin() + static_cast<long>(piece_start - s * old_max_j), src.begin() + static_cast<long>(f - s * old_max_j));
+                        f = piece_start;
+                    }
+                } else {
+                    row.clear();
+                    make_room(row);
+                    append(row, lo, hi);
+                }
+                pad_out(row);
+            }
+        }
+    }
+
+    // Boilerplate code for `blit` and `safe_blit`: copies the `row_ct` x `col_ct` rectangle of `src` at `[i_start, j_start]` to `[dst_i, dst_j]`, both already known to fit.
+    void impl_blit(const Array2D& src, const size_t i_start, const size_t j_start, const size_t row_ct, const size_t col_ct, const size_t dst_i, const size_t dst_j) {
+        if (&src == this) {
+            // a row can then be both source and destination, which is only easy to order with no column shift pending
+            normalize_origin();
+        }
+        YELLE_ARRAY2D_ELEMENTS(row_ct * col_ct, 0);
+        const size_t src_cct = src.colCount();
+        const size_t dst_cct = colCount();
+        // copying onto later rows of the same array, go bottom-up so that no source row is overwritten before it's read
+        const bool bottom_up = (&src == this && dst_i > i_start);
+        for (size_t k=0; k < row_ct; ++k) {
+            const size_t r = (bottom_up ? row_ct - 1 - k : k);
+            const std::vector<T>& from = src.array[src.phys_row(i_start + r)];
+            std::vector<T>& to = array[phys_row(dst_i + r)];
+            if (&from == &to) {
+                // the same row, with no column origin: copy in the direction that reads each element before overwriting it
+                if (dst_j > j_start) {
+                    std::copy_backward(to.begin() + static_cast<long>(j_start), to.begin() + static_cast<long>(j_start + col_ct), to.begin() + static_cast<long>(dst_j + col_ct));
+                } else if (dst_j < j_start) {
+                    std::copy(to.begin() + static_cast<long>(j_start), to.begin() + static_cast<long>(j_start + col_ct), to.begin() + static_cast<long>(dst_j));
+                }
+                continue;
+            }
+            // at most three contiguous runs, split wherever either row's logical columns wrap around its storage
+            size_t from_j = j_start;
+            size_t to_j = dst_j;
+            size_t remaining = col_ct;
+            while (remaining > 0) {
+                const size_t from_p = src.phys_col(from_j);
+                const size_t to_p = phys_col(to_j);
+                const size_t run = std::min({remaining, src_cct - from_p, dst_cct - to_p});
+                std::copy(from.begin() + static_cast<long>(from_p), from.begin() + static_cast<long>(from_p + run), to.begin() + static_cast<long>(to_p));
+                from_j += run;
+                to_j += run;
+                remaining -= run;
+            }
+        }
+    }
+
+    // Pattern search hashes every `h` x `w` window of the array with a 2D polynomial rolling hash (see `hash61`), and only compares the windows whose hash matches the pattern's.
+    // Sets `out[j]` to the hash of logical row `i`'s elements `[j, j+w)`, for every `j <= colCount() - w`. `elems` is scratch space.
+    void hash_row_windows(const size_t i, const size_t w, const uint64_t row_base_pow_w, std::vector<uint64_t>& out, std::vector<uint64_t>& elems) const {
+        const std::vector<T>& row = array[phys_row(i)];
+        const size_t cct = colCount();
+        elems.resize(cct);
+        for (size_t j=0; j < cct; ++j) {
+            elems[j] = hash61::element(row[phys_col(j)]);
+        }
+        out.resize(cct - w + 1);
+        uint64_t h = 0;
+        for (size_t j=0; j < w; ++j) {
+            h = hash61::add(hash61::mul(h, hash61::BASE_J), elems[j]);
+        }
+        out[0] = h;
+        for (size_t j=w; j < cct; ++j) {
+            h = hash61::add(hash61::sub(hash61::mul(h, hash61::BASE_J), hash61::mul(elems[j-w], row_base_pow_w)), elems[j]);
+            out[j-w+1] = h;
+        }
+    }
+
+    // Whether `pattern` appears with its top-left corner at `[i,j]`, which must leave room for all of it.
+    bool matches_at(const Array2D& pattern, const size_t i, const size_t j) const {
+        const size_t pcct = pattern.colCount();
+        for (size_t r=0; r < pattern.rowCount(); ++r) {
+            const std::vector<T>& row = array[phys_row(i + r)];
+            const std::vector<T>& prow = pattern.array[pattern.phys_row(r)];
+            for (size_t c=0; c < pcct; ++c) {
+                if (!(row[phys_col(j + c)] == prow[pattern.phys_col(c)])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Hash of the whole of `pattern`, as `hash_row_windows` and `find_pattern` would hash a window holding it.
+    static uint64_t hash_pattern(const Array2D& pattern) {
+        const size_t w = pattern.colCount();
+        const uint64_t row_base_pow_w = hash61::pow(hash61::BASE_J, w);
+        std::vector<uint64_t> row_hash, elems;
+        uint64_t h = 0;
+        for (size_t r=0; r < pattern.rowCount(); ++r) {
+            pattern.hash_row_windows(r, w, row_base_pow_w, row_hash, elems);
+            h = hash61::add(hash61::mul(h, hash61::BASE_I), row_hash[0]);
+        }
+        return h;
+    }
+
+    // Calls `found(i,j)` for each place `[i,j]` where `pattern` appears, for `i_start <= i < i_past_end`, in row-major order, stopping early if `found` returns `false`.
+    // Keeps the row hashes of the last `pattern.rowCount()` rows in a ring, and rolls each column's window hash down by one row at a time, so each cell costs O(1) however large the pattern is.
+    template <class Found>
+    void find_pattern(const Array2D& pattern, const uint64_t pattern_hash, const size_t i_start, const size_t i_past_end, const Found& found) const {
+        const size_t h = pattern.rowCount();
+        const size_t w = pattern.colCount();
+        const size_t positions = colCount() - w + 1;
+        const uint64_t row_base_pow_w = hash61::pow(hash61::BASE_J, w);
+        const uint64_t col_base_pow_h = hash61::pow(hash61::BASE_I, h);
+        std::vector<std::vector<uint64_t>> ring(h);
+        std::vector<uint64_t> window(positions, 0);
+        std::vector<uint64_t> elems;
+        std::vector<uint64_t> dropped;
+        for (size_t r=0; r < h; ++r) {
+            hash_row_windows(i_start + r, w, row_base_pow_w, ring[r], elems);
+            for (size_t j=0; j < positions; ++j) {
+                window[j] = hash61::add(hash61::mul(window[j], hash61::BASE_I), ring[r][j]);
+            }
+        }
+        for (size_t i=i_start; i < i_past_end; ++i) {
+            if (i > i_start) {
+                // slide every window down a row: drop row `i-1` (whose hashes sit in its ring slot) and add row `i+h-1` in its place
+                std::vector<uint64_t>& slot = ring[(i - 1 - i_start) % h];
+                dropped.swap(slot);
+                hash_row_windows(i + h - 1, w, row_base_pow_w, slot, elems);
+                for (size_t j=0; j < positions; ++j) {
+                    window[j] = hash61::add(hash61::sub(hash61::mul(window[j], hash61::BASE_I), hash61::mul(dropped[j], col_base_pow_h)), slot[j]);
+                }
+            }
+            for (size_t j=0; j < positions; ++j) {
+                if (window[j] == pattern_hash && matches_at(pattern, i, j) && !found(i, j)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // View of one logical row, returned by `operator[]`. Indexing into it accounts for the array's column origin, so `myarray[i][j]` always means logical `[i,j]`.
+    // `begin()`/`end()` walk the row in logical order (wrapping around at the origin), so range-for loops and standard algorithms such as `std::sort(myarray[i].begin(), myarray[i].end())` work over a row as they would over a `std::vector`.
+    template <class Vec, class Ref>
+    struct RowView {
+        private:
+        Vec* row;
+        size_t origin;
+
+        public:
+        // Random-access iterator over the row's elements in logical order.
+        struct Iterator {
+            // --- for standard library interoperability
+            using iterator_category = std::random_access_iterator_tag;
+            using difference_type   = std::ptrdiff_t;
+            using value_type        = T;
+            using pointer           = void;
+            using reference         = Ref;
+            // internals of the iterator
+            private:
+            Vec* row = nullptr;
+            size_t origin = 0;
+            size_t j = 0;   // logical column
+
+            public:
+            Iterator() {
+                return;
+            }
+            Iterator(Vec* r, const size_t orig, const size_t col) : row(r), origin(orig), j(col) {
+                return;
+            }
+            Ref operator*() const {
+                const size_t k = j + origin;
+                return (*row)[k >= row->size() ? k - row->size() : k];
+            }
+            Ref operator[](const difference_type n) const {
+                return *(*this + n);
+            }
+            Iterator& operator++() { ++j; return *this; }
+            Iterator& operator--() { --j; return *this; }
+            Iterator operator++(int) { Iterator old = *this; ++j; return old; }
+            Iterator operator--(int) { Iterator old = *this; --j; return old; }
+            Iterator& operator+=(const difference_type n) { j = static_cast<size_t>(static_cast<difference_type>(j) + n); return *this; }
+            Iterator& operator-=(const difference_type n) { return (*this += -n); }
+            friend Iterator operator+(Iterator it, const difference_type n) { return (it += n); }
+            friend Iterator operator+(const difference_type n, Iterator it) { return (it += n); }
+            friend Iterator operator-(Iterator it, const difference_type n) { return (it -= n); }
+            friend difference_type operator-(const Iterator& a, const Iterator& b) { return static_cast<difference_type>(a.j) - static_cast<difference_type>(b.j); }
+            friend bool operator==(const Iterator& a, const Iterator& b) { return a.j == b.j; }
+            friend bool operator!=(const Iterator& a, const Iterator& b) { return a.j != b.j; }
+            friend bool operator< (const Iterator& a, const Iterator& b) { return a.j <  b.j; }
+            friend bool operator> (const Iterator& a, const Iterator& b) { return a.j >  b.j; }
+            friend bool operator<=(const Iterator& a, const Iterator& b) { return a.j <= b.j; }
+            friend bool operator>=(const Iterator& a, const Iterator& b) { return a.j >= b.j; }
+        };
+
+        RowView(Vec* r, const size_t orig) : row(r), origin(orig) {
+            return;
+        }
+        Iterator begin() const {
+            return Iterator(row, origin, 0);
+        }
+        Iterator end() const {
+            return Iterator(row, origin, row->size());
+        }
+        // access to element `j` of the row, without bounds checking
+        Ref operator[](const size_t j) const {
+            const size_t k = j + origin;
+            return (*row)[k >= row->size() ? k - row->size() : k];
+        }
+        // access to element `j` of the row, throwing a `std::out_of_range` if `j >= size()`
+        Ref at(const size_t j) const {
+            if (j >= row->size()) {
+                throw std::out_of_range("tried to access nonexistent column of array");
+            }
+            return (*this)[j];
+        }
+        size_t size() const {
+            return row->size();
+        }
+        bool empty() const {
+            return row->empty();
+        }
+    };
+    using Row = RowView<std::vector<T>, typename std::vector<T>::reference>;
+    using ConstRow = RowView<const std::vector<T>, typename std::vector<T>::const_reference>;
+
     // Iterator for looping over the whole list, cell-by-cell, row-by-row.
     // Reverse iterators are set up to behave as Standard Library ones do: that performing ++ on them makes them iterate backwards.
     struct EntireIterator {
@@ -36,12 +737,11 @@ protected:
         const iterator_direction direction;
         
         public:
-        // constructor
-        EntireIterator (const Array2D *const refrnt, pointer ptr, const size_t colct, iterator_direction dir = iterator_direction::FORWARD)
-        : referent(refrnt), held_ptr(ptr), curr_row(0), curr_col(0), max_cols(static_cast<long>(colct)), direction(dir) {
-            if (direction == iterator_direction::REVERSED) {
-                curr_row = referent->rowCount() - 1;
-                curr_col = max_cols - 1;
+        // constructor: points at logical `[row,col]` of `refrnt`
+        EntireIterator (const Array2D *const refrnt, const long row, const long col, const size_t colct, iterator_direction dir = iterator_direction::FORWARD)
+        : referent(refrnt), held_ptr(nullptr), curr_row(row), curr_col(col), max_cols(static_cast<long>(colct)), direction(dir) {
+            if (referent != nullptr) {
+                held_ptr = referent->cell_ptr(curr_row, curr_col);
             }
             return;
         }
@@ -73,7 +773,7 @@ protected:
                     curr_col--;
                 }
             }
-            held_ptr = const_cast<pointer>(&(referent->array[curr_row][curr_col]));
+            held_ptr = referent->cell_ptr(curr_row, curr_col);
             return *this;
         }
 
@@ -102,7 +802,7 @@ protected:
                     curr_col++;
                 }
             }
-            held_ptr = const_cast<pointer>(&(referent->array[curr_row][curr_col]));
+            held_ptr = referent->cell_ptr(curr_row, curr_col);
             return *this;
         }
 
@@ -129,12 +829,13 @@ protected:
             return newCopy;
         }
 
+        // iterators are compared by logical position, since the past-the-end positions have no element to point to
         friend bool operator==(const EntireIterator& a, const EntireIterator& b) {
-            return a.held_ptr == b.held_ptr;
+            return a.referent == b.referent && a.curr_row == b.curr_row && a.curr_col == b.curr_col;
         }
 
         friend bool operator!=(const EntireIterator& a, const EntireIterator& b) {
-            return a.held_ptr != b.held_ptr;
+            return !(a == b);
         }
     };
 
@@ -149,17 +850,17 @@ protected:
         using reference         = T&;
         // internals of the iterator
         private:
+        const Array2D* const referent;
         pointer held_ptr;
         long curr_row;
         const size_t fixed_col;
-        const Array2D* const referent;
         const iterator_direction direction;
 
         public:
-        // constructor
-        ColumnIterator(const Array2D *const refrnt, pointer ptr, const size_t col, iterator_direction dir = iterator_direction::FORWARD)
-        : referent(refrnt), held_ptr(ptr), curr_row(0), fixed_col(col), direction(dir) {
-            curr_row = (direction == iterator_direction::FORWARD ? 0 : referent->rowCount());
+        // constructor: points at logical `[row,col]` of `refrnt`
+        ColumnIterator(const Array2D *const refrnt, const long row, const size_t col, iterator_direction dir = iterator_direction::FORWARD)
+        : referent(refrnt), held_ptr(nullptr), curr_row(row), fixed_col(col), direction(dir) {
+            held_ptr = referent->cell_ptr(curr_row, static_cast<long>(fixed_col));
             return;
         }
 
@@ -175,7 +876,7 @@ protected:
         // prefix increment
         ColumnIterator& operator++() {
             curr_row = curr_row + (direction == iterator_direction::FORWARD ? 1 : -1);
-            held_ptr = const_cast<pointer>(&(referent->array[curr_row][fixed_col]));
+            held_ptr = referent->cell_ptr(curr_row, static_cast<long>(fixed_col));
             return *this;
         }
 
@@ -189,7 +890,7 @@ protected:
         // prefix decrement
         ColumnIterator& operator--() {
             curr_row = curr_row - (direction == iterator_direction::FORWARD ? 1 : -1);
-            held_ptr = const_cast<pointer>(&(referent->array[curr_row][fixed_col]));
+            held_ptr = referent->cell_ptr(curr_row, static_cast<long>(fixed_col));
             return *this;
         }
 
@@ -216,12 +917,13 @@ protected:
             return newCopy;
         }
 
+        // iterators are compared by logical position, since the past-the-end positions have no element to point to
         friend bool operator==(const ColumnIterator& a, const ColumnIterator& b) {
-            return a.held_ptr == b.held_ptr;
+            return a.referent == b.referent && a.curr_row == b.curr_row && a.fixed_col == b.fixed_col;
         }
 
         friend bool operator!=(const ColumnIterator& a, const ColumnIterator& b) {
-            return a.held_ptr != b.held_ptr;
+            return !(a == b);
         }
     };
 
@@ -234,6 +936,7 @@ public:
 
     // Double initializer-list constructor: Converts the list of lists into a 2D array.
     Array2D(std::initializer_list<std::initializer_list<T>> list_of_lists) {
+        YELLE_ARRAY2D_OP("constructor");
         //fprintf(stdout, "Creating with double-initlist constructor!\n");
         for (const std::initializer_list<T>& list : list_of_lists) {
             array.push_back(list);
@@ -244,12 +947,15 @@ public:
 
     // Vector-of-Vectors constructor: Copies the values into the `array`.
     explicit Array2D(const std::vector<std::vector<T>>& vec_of_vecs) : array(vec_of_vecs) {
+        YELLE_ARRAY2D_OP("constructor");
         //fprintf(stdout, "Creating with vec-of-vecs constructor!\n");
         verifyDimensions();
+        YELLE_ARRAY2D_ELEMENTS(size(), 0);
         return;
     }
     // Vector-of-Vectors constructor: Moves the values into the `array`.
-    explicit Array2D(std::vector<std::vector<T>>&& vec_of_vecs) : array(vec_of_vecs) {
+    explicit Array2D(std::vector<std::vector<T>>&& vec_of_vecs) : array(std::move(vec_of_vecs)) {
+        YELLE_ARRAY2D_OP("constructor");
         //fprintf(stdout, "Creating with vec-of-vecs constructor!\n");
         verifyDimensions();
         return;
@@ -269,38 +975,115 @@ public:
         return;
     }
 
+#ifdef YELLE_ARRAY2D_INSTRUMENT
+    // When instrumented, copies and moves of whole arrays are counted too. These do exactly what the implicit ones would.
+    // The members start out empty and are assigned in the body, so that the copy itself (its time, element copies, and allocations) falls inside the op's scope.
+    Array2D(const Array2D& other) {
+        YELLE_ARRAY2D_OP("copy");
+        YELLE_ARRAY2D_ELEMENTS(other.size(), 0);
+        array = other.array;
+        row_origin = other.row_origin;
+        col_origin = other.col_origin;
+        reserved_cols = other.reserved_cols;
+        return;
+    }
+    Array2D(Array2D&& other) noexcept {
+        YELLE_ARRAY2D_OP("move");
+        array = std::move(other.array);
+        row_origin = other.row_origin;
+        col_origin = other.col_origin;
+        reserved_cols = other.reserved_cols;
+        other.row_origin = 0;
+        other.col_origin = 0;
+        return;
+    }
+    Array2D& operator=(const Array2D& other) {
+        YELLE_ARRAY2D_OP("copy");
+        YELLE_ARRAY2D_ELEMENTS(other.size(), 0);
+        array = other.array;
+        row_origin = other.row_origin;
+        col_origin = other.col_origin;
+        reserved_cols = other.reserved_cols;
+        return *this;
+    }
+    Array2D& operator=(Array2D&& other) noexcept {
+        YELLE_ARRAY2D_OP("move");
+        array = std::move(other.array);
+        row_origin = other.row_origin;
+        col_origin = other.col_origin;
+        reserved_cols = other.reserved_cols;
+        other.row_origin = 0;
+        other.col_origin = 0;
+        return *this;
+    }
+#endif
+
     /* ============================
         Building/Rebuilding, but Non-Constructor
     ============================= */
     // Returns the array to its original empty state.
     Array2D& clear() {
         array.clear();
+        row_origin = 0;
+        col_origin = 0;
+        return *this;
+    }
+
+    // Makes room for `row_ct` rows of `col_ct` columns, so that appending or inserting rows and columns within that extent never reallocates.
+    // Rows added later are given the same column capacity. Never shrinks the array's capacity; see `shrink_to_fit`.
+    Array2D& reserve(const size_t row_ct, const size_t col_ct) {
+        YELLE_ARRAY2D_OP("reserve");
+        array.reserve(row_ct);
+        reserved_cols = std::max(reserved_cols, col_ct);
+        for (std::vector<T>& row : array) {
+            reserve_row(row);
+        }
+        return *this;
+    }
+
+    // Releases any capacity beyond the array's current dimensions, undoing `reserve` and the geometric growth from adding rows or columns.
+    Array2D& shrink_to_fit() {
+        YELLE_ARRAY2D_OP("shrink_to_fit");
+        reserved_cols = 0;
+        array.shrink_to_fit();
+        for (std::vector<T>& row : array) {
+            row.shrink_to_fit();
+        }
         return *this;
     }
 
     // Empties the array, then fills it as a `newRowCt` x `newColCt` array of `value`s.
+    // The existing rows' storage is reused, so refilling an array of the same shape allocates nothing.
     Array2D& fill(const size_t newRowCt, const size_t newColCt, const T& value) {
-        array.clear();
-        array.reserve(newRowCt);
-        for (size_t i=0; i < newRowCt; ++i) {
-            array.emplace_back();
-            //array[i].reserve(newColCt);
-            array[i] = std::move(std::vector(newColCt, value));
+        YELLE_ARRAY2D_OP("fill");
+        // `value` may be one of this array's own elements
+        const T filler = value;
+        row_origin = 0;
+        col_origin = 0;
+        array.resize(newRowCt);
+        YELLE_ARRAY2D_ELEMENTS(newRowCt * newColCt, 0);
+        for (std::vector<T>& row : array) {
+            if (row.capacity() < newColCt) {
+                row.clear();
+                row.reserve(std::max(reserved_cols, newColCt));
+            }
+            row.assign(newColCt, filler);
         }
         return *this;
     }
 
     // Given an `fopen`ed input file `infile` and a function from `char` type to the desired parameter type for this Array2D, constructs an Array2D of that type. Row separator is '\n', while EOF marks end of array.
     Array2D& build_from_file(FILE* infile, const std::function<T(char)> func) {
+        YELLE_ARRAY2D_OP("build_from_file");
         if (!array.empty()) {
-            array.clear();
+            clear();
         }
         // copy each character from the file line-by-line, adding new rows whenever '\n' is encountered
         std::vector<T> currList;
         char currChar = fgetc(infile);
         while (currChar != EOF) {
             if (currChar == '\n') {
-                array.push_back(currList);
+                array.push_back(reserved_copy(currList.begin(), currList.end()));
                 currList.clear();
             } else if (currChar == '\r') {
                 // do nothing
@@ -311,7 +1094,7 @@ public:
         }
         // if last line of the file didn't end with '\n', then we need to add the last line to the Array2D as well
         if (!currList.empty()) {
-            array.push_back(currList);
+            array.push_back(reserved_copy(currList.begin(), currList.end()));
         }
 
         verifyDimensions();
@@ -320,14 +1103,15 @@ public:
 
     // Given a `std::string` and a function from `char` type to the desired parameter type for this Array2D, constructs an Array2D of that type. Row separator is '\n', while EOF marks end of array.
     Array2D& build_from_string(const std::string instring, const std::function<T(char)> func) {
+        YELLE_ARRAY2D_OP("build_from_string");
         if (!array.empty()) {
-            array.clear();
+            clear();
         }
         // copy each character from the string line-by-line, adding new rows whenever '\n' is encountered
         std::vector<T> currList;
         for (const char currChar : instring) {
             if (currChar == '\n') {
-                array.push_back(currList);
+                array.push_back(reserved_copy(currList.begin(), currList.end()));
                 currList.clear();
             } else if (currChar == '\r') {
                 // do nothing
@@ -337,7 +1121,7 @@ public:
         }
         // if the string didn't end with '\n', then we need to add the last line to the Array2D as well
         if (!currList.empty()) {
-            array.push_back(currList);
+            array.push_back(reserved_copy(currList.begin(), currList.end()));
         }
 
         verifyDimensions();
@@ -345,19 +1129,15 @@ public:
     }
 
     // Change the dimensions of the array to a new shape. Will throw a `std::length_error` if resizing would cause a change in the number of elements.
+    // Free if the shape doesn't change; otherwise each element is moved exactly once, in contiguous runs, and the first row's storage is kept.
     Array2D& resize(const size_t new_max_i, const size_t new_max_j) {
+        YELLE_ARRAY2D_OP("resize");
         const size_t area = size();
         if (new_max_i * new_max_j != area) {
             throw std::length_error("resizing would cause change in element count");
         }
         else if (area > 1) {
-            Array2D oldself;
-            oldself.array.swap(array);
-            fill(new_max_i, new_max_j, oldself[0][0]);
-
-            for (size_t k=1; k < area; ++k) {   // we can skip k=0 because it's already copied in the `fill` above
-                at_bysize(k) = std::move(oldself.at_bysize(k));
-            }
+            reflow(new_max_i, new_max_j, nullptr);
         }
 
         return *this;
@@ -365,40 +1145,24 @@ public:
 
     // Change the dimensions of the array to a new shape, keeping all elements in the order that the begin()...end() iterators would access.
     // If new dimensions are smaller than original, then elements will be trimmed off the end; if larger, then `backup_val` will fill the added cells. 
+    // Kept elements are moved in one bulk pass (see `resize`), and only the added cells are filled.
     Array2D& safe_resize_keeporder(const size_t new_max_i, const size_t new_max_j, const T& backup_val) noexcept {
-        const size_t old_area = size();
-        const size_t new_area = new_max_i * new_max_j;
-        if (new_area == old_area) {
-            resize(new_max_i, new_max_j);
-        }
-        else {
-            // move all current elements into "oldself"
-            Array2D oldself;
-            oldself.array.swap(array);
-            // give `this` an array of new elements 
-            fill(new_max_i, new_max_j, backup_val);
-            // copy everything possible from the original array
-            for (size_t k=0; k < std::min<size_t>(old_area, new_area); ++k) {
-                at_bysize(k) = std::move(oldself.at_bysize(k));
-            }
-            // this second for-loop only runs if the new array is bigger than the old one
-            for (size_t k=old_area; k < new_area; ++k) {
-                at_bysize(k) = backup_val;
-            }
-        }
-
+        YELLE_ARRAY2D_OP("safe_resize_keeporder");
+        reflow(new_max_i, new_max_j, &backup_val);
         return *this;
     }
 
     // Change the dimensions of the array to a new shape, keeping all elements in their (row,column) positions, if possible.
     // If new dimension(s) are smaller than original, then elements will be trimmed off; if larger, then `backup_val` will fill the added cells. 
     Array2D& safe_resize_topleft(const size_t new_max_i, const size_t new_max_j, const T& backup_val) noexcept {
+        YELLE_ARRAY2D_OP("safe_resize_topleft");
         const size_t old_max_i = rowCount();
         const size_t old_max_j = colCount();
         if (old_max_i * old_max_j == new_max_i * new_max_j) {
             resize(new_max_i, new_max_j);
         }
         else {
+            normalize_origin();
             // first, resize all the individual rows' lengths
             const size_t old_max_i = rowCount();
             for (size_t i=0; i < old_max_i; ++i) {
@@ -408,7 +1172,7 @@ public:
             const long i_difference = static_cast<long>(new_max_i) - static_cast<long>(old_max_i);
             if (i_difference > 0) {
                 for (long k=0; k < i_difference; ++k) {
-                    array.emplace_back(new_max_j, backup_val);
+                    array.push_back(reserved_fill(new_max_j, backup_val));
                 }
             } else {
                 array.resize(new_max_i);
@@ -432,7 +1196,10 @@ public:
 
     // Reverses every individual row, or equivalently, the element at `(i,j)` is moved to `(i, colCount - j - 1)`.
     Array2D& flip_horizontal() noexcept {
+        YELLE_ARRAY2D_OP("flip_horizontal");
+        normalize_origin();
         const size_t row_ct = rowCount();
+        YELLE_ARRAY2D_ELEMENTS(0, 3 * (colCount() / 2) * row_ct);
         for (size_t i=0; i < row_ct; ++i) {
             std::reverse(array[i].begin(), array[i].end());
         }
@@ -441,23 +1208,28 @@ public:
 
     // Reverses every individual column, or equivalently, the element at `(i,j)` is moved to `(rowCount - i - 1, j)`.
     Array2D& flip_vertical() noexcept {
+        YELLE_ARRAY2D_OP("flip_vertical");
+        normalize_origin();
         std::reverse(array.begin(), array.end());
         return *this;
     }
 
     // Transposes the array, moving the element at `(i,j)` to `(j,i)`.
     Array2D& transpose() noexcept {
+        YELLE_ARRAY2D_OP("transpose");
+        normalize_origin();
         size_t old_rowCt = rowCount();
         size_t old_colCt = colCount();
         Array2D oldself;
         oldself.array.swap(array);
         array.clear();
         array.reserve(old_colCt);
+        YELLE_ARRAY2D_ELEMENTS(0, old_rowCt * old_colCt);
 
         /* --------- option 1 --------- */
         for (size_t i=0; i < old_colCt; ++i) {
             array.emplace_back();
-            array[i].reserve(old_rowCt);
+            array[i].reserve(std::max(reserved_cols, old_rowCt));
             for (size_t j=0; j < old_rowCt; ++j) {
                 array[i].push_back(std::move(oldself.array[j][i]));
             }
@@ -469,6 +1241,7 @@ public:
 
     // Rotates the array 90° clockwise, equivalent to transposing followed by flipping horizontally.
     Array2D& rotateCW() noexcept {
+        YELLE_ARRAY2D_OP("rotateCW");
         transpose();
         flip_horizontal();
         return *this;
@@ -476,6 +1249,7 @@ public:
 
     // Rotates the array 90° counter-clockwise, equivalent to transposing followed by flipping vertically.
     Array2D& rotateCCW() noexcept {
+        YELLE_ARRAY2D_OP("rotateCCW");
         transpose();
         flip_vertical();
         return *this;
@@ -483,43 +1257,45 @@ public:
 
     // Shifts the array horizontally so that the element at `[i,j]` is moved to `[i, (j+shift_j) % colCount]`.
     // Elements that spill over are looped around to the other end of the array.
+    // This is O(1): only the array's logical origin moves, and no elements are touched.
     Array2D& shift_horizontal(long shift_j) noexcept {
-        const long row_ct = static_cast<long>(rowCount());
         const long col_ct = static_cast<long>(colCount());
-
-        // negative because std::rotate does +rotation to the left, whereas I want +rotation to the right
-        shift_j = -(shift_j % col_ct);
-        if (shift_j == 0) {
+        if (col_ct == 0) {
             return *this;
         }
+        // negative because moving elements right means moving the origin left
+        shift_j = -(shift_j % col_ct);
         if (shift_j < 0) {
             shift_j = col_ct + shift_j;
         }
-
-        for (long i=0; i < row_ct; ++i) {
-            fprintf(stderr, "shifting row %li by %li; array size %li,%li\n", i, shift_j, row_ct, col_ct);
-            auto startpoint = 
-            std::rotate(array[i].begin(), array[i].begin() + static_cast<size_t>(shift_j), array[i].end());
-        }
+        col_origin = (col_origin + static_cast<size_t>(shift_j)) % static_cast<size_t>(col_ct);
 
         return *this;
     }
 
     // Shifts the array horizontally so that the element at `[i,j]` is moved to `[i, j+shift_j]`.
-    // Spaces left empty by the shifting are filled with the `filler` value.
+    // Spaces left empty by the shifting are filled with the `filler` value. Only the refilled strip is written to.
     Array2D& shift_horizontal_fill(long shift_j, const T& filler) noexcept {
-        const long row_ct = static_cast<long>(rowCount());
+        YELLE_ARRAY2D_OP("shift_horizontal_fill");
         const long col_ct = static_cast<long>(colCount());
-        shift_j = shift_j % col_ct;
+        if (col_ct == 0) {
+            return *this;
+        }
+        // shifting by the full width or more leaves nothing behind
+        shift_j = std::clamp<long>(shift_j, -col_ct, col_ct);
 
         shift_horizontal(shift_j);
         const long start_fill_index = (shift_j > 0 ? 0       : col_ct + shift_j );
         const long final_fill_index = (shift_j > 0 ? shift_j : col_ct           );
 
-        for (long i=0; i < row_ct; ++i) {
-            for (long j=start_fill_index; j < final_fill_index; ++j) {
-                array[i][j] = filler;
-            }
+        YELLE_ARRAY2D_ELEMENTS(rowCount() * static_cast<size_t>(final_fill_index - start_fill_index), 0);
+        // the strip is at most two contiguous physical runs per row, split where it wraps past the end of the storage
+        const size_t run_start = phys_col(static_cast<size_t>(start_fill_index));
+        const size_t run_len = static_cast<size_t>(final_fill_index - start_fill_index);
+        const size_t first_len = std::min(run_len, static_cast<size_t>(col_ct) - run_start);
+        for (std::vector<T>& thisRow : array) {
+            std::fill_n(thisRow.begin() + static_cast<long>(run_start), first_len, filler);
+            std::fill_n(thisRow.begin(), run_len - first_len, filler);
         }
 
         return *this;
@@ -527,36 +1303,41 @@ public:
 
     // Shifts the array vertically so that the element at `[i,j]` is moved to `[(i+shift_i) % rowCount, j]`.
     // Elements that spill over are looped around to the other end of the array.
+    // This is O(1): only the array's logical origin moves, and no elements are touched.
     Array2D& shift_vertical(long shift_i) noexcept {
         const long row_ct = static_cast<long>(rowCount());
-        // negative because std::rotate does +rotation to up, whereas I want +rotation down
-        shift_i = -(shift_i % row_ct);
-        if (shift_i == 0) {
+        if (row_ct == 0) {
             return *this;
         }
+        // negative because moving elements down means moving the origin up
+        shift_i = -(shift_i % row_ct);
         if (shift_i < 0) {
             shift_i = row_ct + shift_i;
         }
-
-        std::rotate(array.begin(), array.begin() + static_cast<int>(shift_i), array.end());
+        row_origin = (row_origin + static_cast<size_t>(shift_i)) % static_cast<size_t>(row_ct);
 
         return *this;
     }
 
     // Shifts the array vertically so that the element at `[i,j]` is moved to `[i+shift_i, j]`.
-    // Spaces left empty by the shifting are filled with the `filler` value.
+    // Spaces left empty by the shifting are filled with the `filler` value. Only the refilled strip is written to.
     Array2D& shift_vertical_fill(long shift_i, const T& filler) noexcept {
+        YELLE_ARRAY2D_OP("shift_vertical_fill");
         const long row_ct = static_cast<long>(rowCount());
-        const size_t col_ct = colCount();
-        shift_i = shift_i % row_ct;
+        if (row_ct == 0) {
+            return *this;
+        }
+        // shifting by the full height or more leaves nothing behind
+        shift_i = std::clamp<long>(shift_i, -row_ct, row_ct);
 
         shift_vertical(shift_i);
         const long start_fill_index = (shift_i > 0 ? 0       : row_ct + shift_i );
         const long final_fill_index = (shift_i > 0 ? shift_i : row_ct           );
 
+        // whole rows are refilled, so the column origin doesn't matter here
+        YELLE_ARRAY2D_ELEMENTS(static_cast<size_t>(final_fill_index - start_fill_index) * colCount(), 0);
         for (long i=start_fill_index; i < final_fill_index; ++i) {
-            array[i].clear();
-            array[i] = std::move(std::vector(col_ct, filler));
+            std::fill(array[phys_row(i)].begin(), array[phys_row(i)].end(), filler);
         }
 
         return *this;
@@ -565,28 +1346,29 @@ public:
     /* ============================
         Element Access by Index
     ============================= */
-    // subscript operator: allows access to elements of `array` directly
-    std::vector<T>& operator[](const size_t index) {
-        return array[index];
+    // subscript operator: gives access to row `index` of the array, such that `myarray[i][j]` is the element at `[i,j]`.
+    // The returned row view takes the array's (cyclic-shift) origin into account; it supports `[j]`, `at(j)`, `size()`, and `empty()`.
+    Row operator[](const size_t index) {
+        return Row(&array[phys_row(index)], col_origin);
     }
-    // `const` subscript operator: allows `const`-access to elements of `array` directly
-    const std::vector<T>& operator[](const size_t index) const {
-        return array[index];
+    // `const` subscript operator: gives `const`-access to row `index` of the array, such that `myarray[i][j]` is the element at `[i,j]`.
+    ConstRow operator[](const size_t index) const {
+        return ConstRow(&array[phys_row(index)], col_origin);
     }
 
-    // at-method: allows access to the elements of `array` directly, with bounds checking on the row
-    std::vector<T>& at(const size_t i, const size_t j) {
+    // at-method: allows access to the element at `[i,j]`, with bounds checking
+    T& at(const size_t i, const size_t j) {
         if (i < array.size() && j < array[i].size()) {
-            return array[i][j];
+            return array[phys_row(i)][phys_col(j)];
         } else {
             throw std::out_of_range("tried to access nonexistent row or column of array");
         }
     }
 
-    // `const` at-method: allows `const`-access to the elements of `array` directly, with bounds checking on the row
-    const std::vector<T>& at(const size_t i, const size_t j) const {
+    // `const` at-method: allows `const`-access to the element at `[i,j]`, with bounds checking
+    const T& at(const size_t i, const size_t j) const {
         if (i < array.size() && j < array[i].size()) {
-            return array[i][j];
+            return array[phys_row(i)][phys_col(j)];
         } else {
             throw std::out_of_range("tried to access nonexistent row or column of array");
         }
@@ -595,7 +1377,7 @@ public:
     // returns a `std::optional` copy of the element stored at `[i,j]`. If there is no element at `[i,j]`, then returns a null optional.
     std::optional<T> safe_look(const size_t i, const size_t j) const noexcept {
         if (i < array.size() && j < array[i].size()) {
-            return std::optional<T>(array[i][j]);
+            return std::optional<T>(array[phys_row(i)][phys_col(j)]);
         } else {
             return std::optional<T>();
         }
@@ -607,8 +1389,11 @@ public:
     //     extracted = myarray.at_bysize(k);
     // }```
     T& at_bysize(const size_t index) {
+        if (index >= size()) {
+            throw std::out_of_range("tried to access nonexistent element of array");
+        }
         const size_t cct = colCount();
-        return array.at(index / cct).at(index % cct);
+        return array[phys_row(index / cct)][phys_col(index % cct)];
     }
 
     // Allows `const`-access to the elements of `array` directly, but one-dimensionally. For example:
@@ -617,8 +1402,11 @@ public:
     //     extracted = myarray.at_bysize(k);
     // }```
     const T& at_bysize(const size_t index) const {
+        if (index >= size()) {
+            throw std::out_of_range("tried to access nonexistent element of array");
+        }
         const size_t cct = colCount();
-        return array.at(index / cct).at(index % cct);
+        return array[phys_row(index / cct)][phys_col(index % cct)];
     }
 
     /* ============================
@@ -650,13 +1438,47 @@ public:
         return rowCount() == colCount();
     }
 
+    // Returns the number of rows the array can hold before adding another row would reallocate its table of rows.
+    size_t rowCapacity() const {
+        return array.capacity();
+    }
+
+    // Returns the number of columns that every row can hold before adding another column would reallocate some row, i.e. the smallest capacity of any row.
+    // For an array without any rows, this is the capacity that new rows will be given.
+    size_t colCapacity() const {
+        if (array.empty()) {
+            return reserved_cols;
+        }
+        size_t smallest = array[0].capacity();
+        for (const std::vector<T>& row : array) {
+            smallest = std::min(smallest, row.capacity());
+        }
+        return smallest;
+    }
+
+    // Returns the number of elements the array can hold without reallocating, as `rowCapacity() * colCapacity()`.
+    size_t capacity() const {
+        return rowCapacity() * colCapacity();
+    }
+
+    // Returns the number of bytes held by the array: the object itself, the outer vector's buffer (one `std::vector<T>` header per row it has room for), and every row's buffer at its full capacity.
+    // Memory that elements own themselves (e.g. the characters of a long `std::string`) isn't included.
+    size_t memory_footprint() const {
+        size_t bytes = sizeof(*this) + array.capacity() * sizeof(std::vector<T>);
+        for (const std::vector<T>& row : array) {
+            bytes += row.capacity() * sizeof(T);
+        }
+        return bytes;
+    }
+
     // Produces a `std::string` representation of the 2D array; elements are separated by `\t`, and rows by `\n`.
     // Requires there to be an overload of `operator<<` for the elements onto a `std::stringstream`.
     std::string to_string() const {
+        YELLE_ARRAY2D_OP("to_string");
         std::stringstream oss;
         for (size_t i=0; i < rowCount(); ++i) {
             for (size_t j=0; j < colCount(); ++j) {
-                oss << array[i][j] << "\t";
+                oss << array[phys_row(i)][phys_col(j)] << "\t";
             }
             oss << "\n";
         }
@@ -701,6 +1523,7 @@ public:
     // `myarray.foldl(f,acc) == f( f( f(acc, a[0]), a[1]), a[2])`
     template <class S>
     S foldl(const std::function<S(S,T)> func, S accumulator, const bool first_is_accumulator=false) const {
+        YELLE_ARRAY2D_OP("foldl");
         if (empty()) {
             throw std::length_error("cannot use foldl on empty array");
         } else {
@@ -722,6 +1545,7 @@ public:
     // `myarray.foldr(f,acc) == f(a[0], f(a[1], f(a[2], acc)))`
     template <class S>
     S foldr(const std::function<S(T,S)> func, S accumulator, const bool last_is_accumulator=false) const {
+        YELLE_ARRAY2D_OP("foldr");
         if (empty()) {
             throw std::length_error("cannot use foldr on empty array");
         } else {
@@ -743,6 +1567,7 @@ public:
     // `myarray.foldl_col(f,acc) == f( f( f(acc, a[0]), a[1]), a[2])`
     template <class S>
     S foldl_col(const size_t col_j, const std::function<S(S,T)> func, S accumulator, const bool first_is_accumulator=false) const {
+        YELLE_ARRAY2D_OP("foldl_col");
         if (empty()) {
             throw std::length_error("cannot use foldl_col on empty array");
         } else if (col_j >= colCount()) {
@@ -766,6 +1591,7 @@ public:
     // `myarray.foldr_col(f,acc) == f(a[0], f(a[1], f(a[2], acc)))`
     template <class S>
     S foldr_col(const size_t col_j, const std::function<S(T,S)> func, S accumulator, const bool last_is_accumulator=false) const {
+        YELLE_ARRAY2D_OP("foldr_col");
         if (empty()) {
             throw std::length_error("cannot use foldr_col on empty array");
         } else if (col_j >= colCount()) {
@@ -809,6 +1635,77 @@ public:
         return foldl_col(column_j, T_multiplication);
     }
 
+    /* ============================
+        Pattern Search
+    ============================= */
+    // Positions `{i,j}` of the top-left corner of every place where `pattern` appears in this array (as a contiguous block of equal elements), in row-major order. Matches may overlap.
+    // Runs in O(size() + pattern.size()) expected time, by comparing 2D rolling hashes of every window and checking only the windows whose hash matches; no sub-arrays are copied.
+    // Elements are hashed with `std::hash<T>`; for a `T` without one, every window is compared in full instead.
+    // With `threads > 1`, splits the rows into horizontal strips that are searched in parallel (`0` for the hardware's concurrency).
+    // An empty pattern, or one larger than the array, is found nowhere.
+    std::vector<std::pair<size_t, size_t>> find_all(const Array2D& pattern, size_t threads = 1) const {
+        YELLE_ARRAY2D_OP("find_all");
+        std::vector<std::pair<size_t, size_t>> found;
+        if (pattern.empty() || pattern.rowCount() > rowCount() || pattern.colCount() > colCount()) {
+            return found;
+        }
+        const uint64_t pattern_hash = hash_pattern(pattern);
+        const size_t i_count = rowCount() - pattern.rowCount() + 1;
+        // each strip rehashes the `pattern.rowCount() - 1` rows below it, so don't let that overlap dominate
+        const size_t min_rows_per_thread = std::max<size_t>(64, 4 * pattern.rowCount());
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        const size_t strips = std::max<size_t>(1, std::min(threads, i_count / min_rows_per_thread));
+        if (strips == 1) {
+            find_pattern(pattern, pattern_hash, 0, i_count, [&found](const size_t i, const size_t j) {
+                found.emplace_back(i, j);
+                return true;
+            });
+            return found;
+        }
+        const size_t strip_rows = (i_count + strips - 1) / strips;
+        std::vector<std::vector<std::pair<size_t, size_t>>> strip_found(strips);
+        const auto search_strip = [&](const size_t s) {
+            const size_t i_start = std::min(i_count, s * strip_rows);
+            const size_t i_past_end = std::min(i_count, i_start + strip_rows);
+            if (i_start < i_past_end) {
+                find_pattern(pattern, pattern_hash, i_start, i_past_end, [&strip_found, s](const size_t i, const size_t j) {
+                    strip_found[s].emplace_back(i, j);
+                    return true;
+                });
+            }
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(strips - 1);
+        for (size_t s=1; s < strips; ++s) {
+            pool.emplace_back(search_strip, s);
+        }
+        search_strip(0);
+        for (std::thread& t : pool) {
+            t.join();
+        }
+        for (const auto& strip : strip_found) {
+            found.insert(found.end(), strip.begin(), strip.end());
+        }
+        return found;
+    }
+
+    // Position `{i,j}` of the top-left corner of the first place (in row-major order) where `pattern` appears in this array, or `std::nullopt` if it appears nowhere.
+    // Searches as `find_all` does, stopping at the first match.
+    std::optional<std::pair<size_t, size_t>> find_first(const Array2D& pattern) const {
+        YELLE_ARRAY2D_OP("find_first");
+        std::optional<std::pair<size_t, size_t>> first;
+        if (pattern.empty() || pattern.rowCount() > rowCount() || pattern.colCount() > colCount()) {
+            return first;
+        }
+        find_pattern(pattern, hash_pattern(pattern), 0, rowCount() - pattern.rowCount() + 1, [&first](const size_t i, const size_t j) {
+            first.emplace(i, j);
+            return false;
+        });
+        return first;
+    }
+
     /* ============================
         Adding rows to the array
     ============================= */
@@ -816,11 +1713,13 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `colCount()`.
     Array2D& insert_row(const size_t position, const std::vector<T>& new_row) {
+        YELLE_ARRAY2D_OP("insert_row");
+        normalize_origin();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert a row at index %zu into an array with only %zu rows!\n", position, rowCount());
             throw std::out_of_range("tried to add row at too-high index value");
         } else if (new_row.size() == colCount() || size() == 0) {
-            array.insert(array.begin()+position, new_row);
+            array.insert(array.begin()+position, reserved_copy(new_row.begin(), new_row.end()));
         } else {
             fprintf(stderr, "Attempted to insert a row of length %zu into an array with row-length %zu!\n", new_row.size(), colCount());
             throw std::length_error("tried to add row of incorrect length");
@@ -833,10 +1732,13 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `colCount()`.
     Array2D& insert_row(const size_t position, std::vector<T>&& new_row) {
+        YELLE_ARRAY2D_OP("insert_row");
+        normalize_origin();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert a row at index %zu into an array with only %zu rows!\n", position, rowCount());
             throw std::out_of_range("tried to add row at too-high index value");
         } else if (new_row.size() == colCount() || size() == 0) {
+            reserve_row(new_row);
             array.insert(array.begin()+position, std::move(new_row));
         } else {
             fprintf(stderr, "Attempted to insert a row of length %zu into an array with row-length %zu!\n", new_row.size(), colCount());
@@ -850,11 +1752,13 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `colCount()`.
     Array2D& insert_row(const size_t position, std::initializer_list<T> new_row) {
+        YELLE_ARRAY2D_OP("insert_row");
+        normalize_origin();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert a row at index %zu into an array with only %zu rows!\n", position, rowCount());
             throw std::out_of_range("tried to add row at too-high index value");
         } else if (new_row.size() == colCount() || size() == 0) {
-            array.insert(array.begin()+position, new_row);
+            array.insert(array.begin()+position, reserved_copy(new_row.begin(), new_row.end()));
         } else {
             fprintf(stderr, "Attempted to insert a row of length %zu into an array with row-length %zu!\n", new_row.size(), colCount());
             throw std::length_error("tried to add row of incorrect length");
@@ -867,27 +1771,21 @@ public:
     // Will trim the row if too long, or pad the row with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_row(const size_t position, const std::vector<T>& new_row, const T& backup_val) noexcept {
+        YELLE_ARRAY2D_OP("safe_insert_row");
+        normalize_origin();
         const size_t col_ct = colCount();
         const size_t newrow_ct = new_row.size();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert row (of length %zu) into row-index %zu of array, but array has only %zu rows... Returning array unchanged.\n", newrow_ct, position, rowCount());
         }
         else if (empty()) {
-            array.push_back(new_row);
-        }
-        else if (newrow_ct >= col_ct) {
-            const size_t overshoot_columns = newrow_ct - col_ct;
-            array.insert(array.begin()+position, new_row);
-            for (size_t k=0; k < overshoot_columns; ++k) {
-                array[position].erase(array[position].begin() + col_ct);
-            }
+            array.push_back(reserved_copy(new_row.begin(), new_row.end()));
         }
         else {
-            const size_t missing_columns = col_ct - newrow_ct;
-            array.insert(array.begin()+position, new_row);
-            for (size_t k=0; k < missing_columns; ++k) {
-                array[position].push_back(backup_val);
-            }
+            // copy only as much of `new_row` as fits, then pad out the rest
+            std::vector<T> row = reserved_copy(new_row.begin(), new_row.begin() + std::min(newrow_ct, col_ct));
+            row.resize(col_ct, backup_val);
+            array.insert(array.begin()+position, std::move(row));
         }
         //verifyDimensions();
         return *this;
@@ -897,27 +1795,22 @@ public:
     // Will trim the row if too long, or pad the row with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_row(const size_t position, std::vector<T>&& new_row, const T& backup_val) noexcept {
+        YELLE_ARRAY2D_OP("safe_insert_row");
+        normalize_origin();
         const size_t col_ct = colCount();
         const size_t newrow_ct = new_row.size();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert row (of length %zu) into row-index %zu of array, but array has only %zu rows... Returning array unchanged.\n", newrow_ct, position, rowCount());
         }
         else if (empty()) {
+            reserve_row(new_row);
             array.push_back(std::move(new_row));
         }
-        else if (newrow_ct >= col_ct) {
-            const size_t overshoot_columns = newrow_ct - col_ct;
-            array.insert(array.begin()+position, std::move(new_row));
-            for (size_t k=0; k < overshoot_columns; ++k) {
-                array[position].erase(array[position].begin() + col_ct);
-            }
-        }
         else {
-            const size_t missing_columns = col_ct - newrow_ct;
+            // trims or pads, as needed
+            new_row.resize(col_ct, backup_val);
+            reserve_row(new_row);
             array.insert(array.begin()+position, std::move(new_row));
-            for (size_t k=0; k < missing_columns; ++k) {
-                array[position].push_back(backup_val);
-            }
         }
         //verifyDimensions();
         return *this;
@@ -927,27 +1820,21 @@ public:
     // Will trim the row if too long, or pad the row with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_row(const size_t position, std::initializer_list<T> new_row, const T& backup_val) noexcept {
+        YELLE_ARRAY2D_OP("safe_insert_row");
+        normalize_origin();
         const size_t col_ct = colCount();
         const size_t newrow_ct = new_row.size();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insert row (of length %zu) into row-index %zu of array, but array has only %zu rows... Returning array unchanged.\n", newrow_ct, position, rowCount());
         }
         else if (empty()) {
-            array.emplace_back(new_row);
-        }
-        else if (newrow_ct >= col_ct) {
-            const size_t overshoot_columns = newrow_ct - col_ct;
-            array.insert(array.begin()+position, new_row);
-            for (size_t k=0; k < overshoot_columns; ++k) {
-                array[position].erase(array[position].begin() + col_ct);
-            }
+            array.push_back(reserved_copy(new_row.begin(), new_row.end()));
         }
         else {
-            const size_t missing_columns = col_ct - newrow_ct;
-            array.insert(array.begin()+position, new_row);
-            for (size_t k=0; k < missing_columns; ++k) {
-                array[position].push_back(backup_val);
-            }
+            // copy only as much of `new_row` as fits, then pad out the rest
+            std::vector<T> row = reserved_copy(new_row.begin(), new_row.begin() + std::min(newrow_ct, col_ct));
+            row.resize(col_ct, backup_val);
+            array.insert(array.begin()+position, std::move(row));
         }
         //verifyDimensions();
         return *this;
@@ -964,7 +1851,7 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `colCount()`.
     Array2D& append_row(std::vector<T>&& new_row) {
-        return insert_row(array.size(), new_row);
+        return insert_row(array.size(), std::move(new_row));
     }
 
     // Append an initializer list `new_row` as a new row at the bottom edge of the array via the value-constructor of the contained type `T`.
@@ -985,7 +1872,7 @@ public:
     // Will trim the row if too long, or pad the row with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_append_row(std::vector<T>&& new_row, const T& backup_val) {
-        return safe_insert_row(array.size(), new_row, backup_val);
+        return safe_insert_row(array.size(), std::move(new_row), backup_val);
     }
 
     // Append an initializer list `new_row` as a new row at the bottom edge of the array via the value-constructor of the contained type `T`.
@@ -998,11 +1885,13 @@ public:
     // Insert a new row at index `position`, with each element filled as `fillvalue`.
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
     Array2D& insertfill_row(const size_t position, const T& fillvalue) {
+        YELLE_ARRAY2D_OP("insertfill_row");
+        normalize_origin();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insertfill a row at index %zu into an array with only %zu rows!\n", position, rowCount());
             throw std::out_of_range("tried to add row at too-high index value");
         } else {
-            array.insert(array.begin()+position, std::vector<T>(colCount(), fillvalue));
+            array.insert(array.begin()+position, reserved_fill(colCount(), fillvalue));
         }
         return *this;
     }
@@ -1010,10 +1899,12 @@ public:
     // Insert a new row at index `position`, with each element filled as `fillvalue`.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insertfill_row(const size_t position, const T& fillvalue) {
+        YELLE_ARRAY2D_OP("safe_insertfill_row");
+        normalize_origin();
         if (position > rowCount()) {
             fprintf(stderr, "Attempted to insertfill a row at index %zu into an array with only %zu rows!\nReturning array unchanged.\n", position, array.size());
         } else {
-            array.insert(array.begin()+position, std::move(std::vector<T>(colCount(), fillvalue)));
+            array.insert(array.begin()+position, reserved_fill(colCount(), fillvalue));
         }
         return *this;
     }
@@ -1025,6 +1916,8 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `colCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `rowCount()`.
     Array2D& insert_col(const size_t position, const std::vector<T>& new_col) {
+        YELLE_ARRAY2D_OP("insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         
         if (position > colCount()) {
@@ -1034,10 +1927,13 @@ public:
         else if (row_ct == 0) {
             for (size_t i=0; i < new_col.size(); ++i) {
                 array.emplace_back();
+                reserve_row(array[i]);
                 array[i].push_back(new_col[i]);
             }
         }
         else if (new_col.size() == row_ct) {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(row_ct, row_ct * (colCount() - position));
             for (size_t i=0; i < row_ct; ++i) {
                 array[i].insert(array[i].begin()+position, new_col[i]);
             }
@@ -1053,7 +1949,9 @@ public:
     // Insert elements from the vector `new_col` as a new column in the array via the `std::move` constructor.
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `colCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `rowCount()`.
-    Array2D& insert_col(const size_t position, const std::vector<T>&& new_col) {
+    Array2D& insert_col(const size_t position, std::vector<T>&& new_col) {
+        YELLE_ARRAY2D_OP("insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         if (position > colCount()) {
             fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns!\n", position, colCount());
@@ -1062,10 +1960,13 @@ public:
         else if (row_ct == 0) {
             for (size_t i=0; i < new_col.size(); ++i) {
                 array.emplace_back();
+                reserve_row(array[i]);
                 array[i].push_back(std::move(new_col[i]));
             }
         }
         else if (new_col.size() == row_ct) {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(0, row_ct * (colCount() - position + 1));
             for (size_t i=0; i < row_ct; ++i) {
                 array[i].insert(array[i].begin()+position, std::move(new_col[i]));
             }
@@ -1082,6 +1983,8 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `colCount()` are valid.
     // Will throw a `std::length_error` if new row does not have the same length as `rowCount()`.
     Array2D& insert_col(const size_t position, std::initializer_list<T> new_col) {
+        YELLE_ARRAY2D_OP("insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         if (position > colCount()) {
             fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns!\n", position, colCount());
@@ -1090,10 +1993,13 @@ public:
         else if (row_ct == 0) {
             for (size_t i=0; i < new_col.size(); ++i) {
                 array.emplace_back();
+                reserve_row(array[i]);
                 array[i].push_back(*(new_col.begin()+i));
             }
         }
         else if (new_col.size() == row_ct) {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(row_ct, row_ct * (colCount() - position));
             for (size_t i=0; i < row_ct; ++i) {
                 array[i].insert(array[i].begin() + position, *(new_col.begin()+i));
             }
@@ -1110,6 +2016,8 @@ public:
     // Will trim the column if too long, or pad the column with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_col(const size_t position, const std::vector<T>& new_col, const T& backup_val) {
+        YELLE_ARRAY2D_OP("safe_insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         if (position > colCount()) {
             fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns... Returning array unchanged.\n", position, colCount());
@@ -1118,6 +2026,8 @@ public:
             insert_col(position, new_col);
         }
         else {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(row_ct, row_ct * (colCount() - position));
             for (size_t i=0; i < row_ct; ++i) {
                 if (i < new_col.size()) {
                     array[i].insert(array[i].begin() + position, new_col[i]);
@@ -1136,6 +2046,8 @@ public:
     // Will trim the column if too long, or pad the column with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_col(const size_t position, std::vector<T>&& new_col, const T& backup_val) {
+        YELLE_ARRAY2D_OP("safe_insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         if (position > colCount()) {
             fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns... Returning array unchanged.\n", position, colCount());
@@ -1144,6 +2056,8 @@ public:
             insert_col(position, std::move(new_col));
         }
         else {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(0, row_ct * (colCount() - position + 1));
             for (size_t i=0; i < row_ct; ++i) {
                 if (i < new_col.size()) {
                     array[i].insert(array[i].begin() + position, std::move(new_col[i]));
@@ -1162,6 +2076,8 @@ public:
     // Will trim the column if too long, or pad the column with `backup_val` if too short.
     // If insertion is attempted out-of-range, a message is printed to `stderr`, and the array is returned unchanged.
     Array2D& safe_insert_col(const size_t position, std::initializer_list<T> new_col, const T& backup_val) {
+        YELLE_ARRAY2D_OP("safe_insert_col");
+        normalize_origin();
         const size_t row_ct = rowCount();
         if (position > colCount()) {
             fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns... Returning array unchanged.\n", position, colCount());
@@ -1170,6 +2086,8 @@ public:
             insert_col(position, new_col);
         }
         else {
+            grow_cols(colCount() + 1);
+            YELLE_ARRAY2D_ELEMENTS(row_ct, row_ct * (colCount() - position));
             for (size_t i=0; i < row_ct; ++i) {
                 if (i < new_col.size()) {
                     array[i].insert(array[i].begin() + position, *(new_col.begin()+i));
@@ -1251,6 +2169,8 @@ public:
     // Delete a single row at row-index `i`.
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()-1` are valid.
     Array2D& delete_row(const size_t i) {
+        YELLE_ARRAY2D_OP("delete_row");
+        normalize_origin();
         if (i >= rowCount()) {
             fprintf(stderr, "Tried to delete row %zu from an Array2D with %zu rows!\n", i, rowCount());
             throw std::out_of_range("cannot delete row outside of valid range");
@@ -1264,6 +2184,8 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()-1` are valid for `i_start`, and only indices from `0` to `rowCount()` for `i_past_end`.
     // If indices are valid, but `i_start >= i_past_end`, then silently no deletion occurs.
     Array2D& delete_rows(const size_t i_start, const size_t i_past_end) {
+        YELLE_ARRAY2D_OP("delete_rows");
+        normalize_origin();
         if (i_start >= rowCount() || i_past_end > rowCount()) {
             fprintf(stderr, "Tried to delete rows [%zu,%zu) from an Array2D with %zu rows!\n", i_start, i_past_end, rowCount());
             throw std::out_of_range("cannot delete rows outside of valid range");
@@ -1280,11 +2202,14 @@ public:
     // Delete a single column at column-index `i`.
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `colCount()-1` are valid.
     Array2D& delete_col(const size_t j) {
+        YELLE_ARRAY2D_OP("delete_col");
+        normalize_origin();
         if (j >= colCount()) {
             fprintf(stderr, "Tried to delete column %zu from an Array2D with %zu columns!\n", j, colCount());
             throw std::out_of_range("cannot delete column outside of valid range");
         } else {
             const size_t row_ct = rowCount();
+            YELLE_ARRAY2D_ELEMENTS(0, row_ct * (colCount() - j - 1));
             // would a for-each loop work here?
             for (size_t i=0; i < row_ct; ++i) {
                 std::vector<T>& thisRow = array[i];
@@ -1298,12 +2223,15 @@ public:
     // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `colCount()-1` are valid for `j_start`, and only indices from `0` to `colCount()` for `j_past_end`.
     // If indices are valid, but `j_start >= j_past_end`, then silently no deletion occurs.
     Array2D& delete_cols(const size_t j_start, const size_t j_past_end) {
+        YELLE_ARRAY2D_OP("delete_cols");
+        normalize_origin();
         if (j_start >= colCount() || j_past_end > colCount()) {
             fprintf(stderr, "Tried to delete columns [%zu,%zu) from an Array2D with %zu columns!\n", j_start, j_past_end, colCount());
             throw std::out_of_range("cannot delete columns outside of valid range");
         }
         else if (j_start < j_past_end) {
             const size_t row_ct = rowCount();
+            YELLE_ARRAY2D_ELEMENTS(0, row_ct * (colCount() - j_past_end));
             // would a for-each loop work here?
             for (size_t i=0; i < row_ct; ++i) {
                 std::vector<T>& thisRow = array[i];
@@ -1316,6 +2244,411 @@ public:
         return *this;
     }
 
+    /* ============================
+        Cropping, Padding, and Blitting
+    ============================= */
+
+    // Shrinks the array down to the rectangle `[i_start, i_past_end) x [j_start, j_past_end)`. Note that the `past_end` indices are excluded.
+    // Will throw a `std::out_of_range` error if the rectangle doesn't fit in the array. If it's empty (`i_start >= i_past_end` or `j_start >= j_past_end`), the array is emptied.
+    // The kept rows are rotated to the front (moving only row handles), and each kept row slides its elements down in one bulk move. Nothing is allocated, unless a pending horizontal shift makes the kept columns wrap around the storage; then one scratch buffer is used to put each row's two halves back in order.
+    Array2D& crop(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+        YELLE_ARRAY2D_OP("crop");
+        if (i_past_end > rowCount() || j_past_end > colCount()) {
+            fprintf(stderr, "Tried to crop an Array2D with %zu rows and %zu columns to [%zu,%zu)x[%zu,%zu)!\n", rowCount(), colCount(), i_start, i_past_end, j_start, j_past_end);
+            throw std::out_of_range("cannot crop to a rectangle outside of valid range");
+        }
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return clear();
+        }
+        const size_t row_ct = i_past_end - i_start;
+        const size_t col_ct = j_past_end - j_start;
+        const size_t cct = colCount();
+
+        std::rotate(array.begin(), array.begin() + static_cast<long>(phys_row(i_start)), array.end());
+        array.erase(array.begin() + static_cast<long>(row_ct), array.end());
+        row_origin = 0;
+
+        YELLE_ARRAY2D_ELEMENTS(0, row_ct * col_ct);
+        const size_t first = phys_col(j_start);
+        std::vector<unsigned char> buffer;
+        for (std::vector<T>& row : array) {
+            if (first + col_ct <= cct) {
+                row.erase(row.begin() + static_cast<long>(first + col_ct), row.end());
+                row.erase(row.begin(), row.begin() + static_cast<long>(first));
+            } else {
+                // the kept columns wrap around the end of the storage: drop the gap between their two halves, then put the halves back in order
+                const size_t wrapped = first + col_ct - cct;
+                row.erase(row.begin() + static_cast<long>(wrapped), row.begin() + static_cast<long>(first));
+                rotate_row(row, wrapped, buffer);
+            }
+        }
+        col_origin = 0;
+        return *this;
+    }
+
+    // Grows the array by `top` new rows above, `bottom` below, `left` new columns to the left and `right` to the right, all filled with `value`.
+    // Each existing row is widened in place if it already has the capacity (see `reserve`), and otherwise rebuilt once into storage of the new width; each new row is allocated once.
+    Array2D& pad(const size_t top, const size_t bottom, const size_t left, const size_t right, const T& value) {
+        YELLE_ARRAY2D_OP("pad");
+        // `value` may be one of this array's own elements
+        const T filler = value;
+        const size_t new_max_i = rowCount() + top + bottom;
+        const size_t new_max_j = colCount() + left + right;
+        if (size() == 0) {
+            return fill(new_max_i, new_max_j, filler);
+        }
+
+        if (left + right > 0) {
+            YELLE_ARRAY2D_ELEMENTS(rowCount() * (left + right), size());
+            std::vector<unsigned char> buffer;
+            for (std::vector<T>& row : array) {
+                if (row.capacity() >= new_max_j) {
+                    if (col_origin != 0) {
+                        rotate_row(row, col_origin, buffer);
+                    }
+                    row.insert(row.begin(), left, filler);
+                    row.insert(row.end(), right, filler);
+                } else {
+                    std::vector<T> wider;
+                    wider.reserve(std::max(reserved_cols, new_max_j));
+                    wider.insert(wider.end(), left, filler);
+                    wider.insert(wider.end(), std::make_move_iterator(row.begin() + static_cast<long>(col_origin)), std::make_move_iterator(row.end()));
+                    wider.insert(wider.end(), std::make_move_iterator(row.begin()), std::make_move_iterator(row.begin() + static_cast<long>(col_origin)));
+                    wider.insert(wider.end(), right, filler);
+                    row.swap(wider);
+                }
+            }
+            col_origin = 0;
+        }
+
+        if (top + bottom > 0) {
+            YELLE_ARRAY2D_ELEMENTS((top + bottom) * new_max_j, 0);
+            std::rotate(array.begin(), array.begin() + static_cast<long>(row_origin), array.end());
+            row_origin = 0;
+            array.reserve(new_max_i);
+            array.insert(array.begin(), top, std::vector<T>());
+            array.insert(array.end(), bottom, std::vector<T>());
+            for (size_t i=0; i < top; ++i) {
+                array[i] = reserved_fill(new_max_j, filler);
+            }
+            for (size_t i=new_max_i-bottom; i < new_max_i; ++i) {
+                array[i] = reserved_fill(new_max_j, filler);
+            }
+        }
+        return *this;
+    }
+
+    // Copies the rectangle `[i_start, i_past_end) x [j_start, j_past_end)` of `src` into this array, so that its top-left corner lands at `[dst_i, dst_j]`.
+    // `src` may be this array itself, with the two rectangles overlapping: rows and columns are then copied in whichever order reads each element before it's overwritten.
+    // Will throw a `std::out_of_range` error if the rectangle doesn't fit in `src`, or doesn't fit in this array once moved; see `safe_blit` for a version that clips instead.
+    // If indices are valid, but the rectangle is empty, then silently nothing is copied.
+    Array2D& blit(const Array2D& src, const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end, const size_t dst_i, const size_t dst_j) {
+        YELLE_ARRAY2D_OP("blit");
+        if (i_past_end > src.rowCount() || j_past_end > src.colCount()) {
+            fprintf(stderr, "Tried to blit [%zu,%zu)x[%zu,%zu) from an Array2D with %zu rows and %zu columns!\n", i_start, i_past_end, j_start, j_past_end, src.rowCount(), src.colCount());
+            throw std::out_of_range("cannot blit from a rectangle outside of valid range");
+        }
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return *this;
+        }
+        const size_t row_ct = i_past_end - i_start;
+        const size_t col_ct = j_past_end - j_start;
+        if (dst_i > rowCount() || row_ct > rowCount() - dst_i || dst_j > colCount() || col_ct > colCount() - dst_j) {
+            fprintf(stderr, "Tried to blit a %zux%zu rectangle to [%zu,%zu] of an Array2D with %zu rows and %zu columns!\n", row_ct, col_ct, dst_i, dst_j, rowCount(), colCount());
+            throw std::out_of_range("cannot blit to a rectangle outside of valid range");
+        }
+        impl_blit(src, i_start, j_start, row_ct, col_ct, dst_i, dst_j);
+        return *this;
+    }
+
+    // Copies all of `src` into this array, so that its top-left corner lands at `[dst_i, dst_j]`. Throws just as `blit` does.
+    Array2D& blit(const Array2D& src, const size_t dst_i, const size_t dst_j) {
+        return blit(src, 0, 0, src.rowCount(), src.colCount(), dst_i, dst_j);
+    }
+
+    // Like `blit`, but the rectangle is clipped to fit both `src` and this array, so it never throws for being out of range.
+    // The destination corner `[dst_i, dst_j]` may be negative, leaving the rectangle's top and/or left edge off of the array, as when compositing a sprite that is partly off-screen.
+    Array2D& safe_blit(const Array2D& src, size_t i_start, size_t j_start, size_t i_past_end, size_t j_past_end, long dst_i, long dst_j) {
+        YELLE_ARRAY2D_OP("safe_blit");
+        i_past_end = std::min(i_past_end, src.rowCount());
+        j_past_end = std::min(j_past_end, src.colCount());
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return *this;
+        }
+        // move a negative corner onto the array, trimming the rectangle to match
+        if (dst_i < 0) {
+            if (static_cast<size_t>(-dst_i) >= i_past_end - i_start) {
+                return *this;
+            }
+            i_start += static_cast<size_t>(-dst_i);
+            dst_i = 0;
+        }
+        if (dst_j < 0) {
+            if (static_cast<size_t>(-dst_j) >= j_past_end - j_start) {
+                return *this;
+            }
+            j_start += static_cast<size_t>(-dst_j);
+            dst_j = 0;
+        }
+        if (static_cast<size_t>(dst_i) >= rowCount() || static_cast<size_t>(dst_j) >= colCount()) {
+            return *this;
+        }
+        const size_t row_ct = std::min(i_past_end - i_start, rowCount() - static_cast<size_t>(dst_i));
+        const size_t col_ct = std::min(j_past_end - j_start, colCount() - static_cast<size_t>(dst_j));
+        impl_blit(src, i_start, j_start, row_ct, col_ct, static_cast<size_t>(dst_i), static_cast<size_t>(dst_j));
+        return *this;
+    }
+
+    /* ============================
+        Batched Structural Edits
+    ============================= */
+    // A recorded sequence of row/column insertions and deletions, to be applied all at once by `apply_edits`.
+    // Each edit's indices refer to the array as it will be after all of the earlier edits in the plan, exactly as if the corresponding methods had been called one after another.
+    // Nothing is checked while recording; `apply_edits` validates the whole plan before touching the array.
+    class EditPlan {
+        friend class Array2D;
+        enum class edit_kind { INSERT_ROW, INSERTFILL_ROW, DELETE_ROWS, INSERT_COL, INSERTFILL_COL, DELETE_COLS };
+        struct Edit {
+            edit_kind kind;
+            size_t start;               // insertion position, or first deleted index
+            size_t past_end;            // one past the last deleted index (deletions only)
+            std::vector<T> values;      // inserted row/column (`INSERT_ROW` and `INSERT_COL` only)
+            std::optional<T> fill;      // fill value (`INSERTFILL_ROW` and `INSERTFILL_COL` only)
+        };
+        std::vector<Edit> edits;
+
+        EditPlan& record(const edit_kind kind, const size_t start, const size_t past_end, std::vector<T>&& values, std::optional<T>&& fill) {
+            edits.push_back(Edit{kind, start, past_end, std::move(values), std::move(fill)});
+            return *this;
+        }
+
+    public:
+        // Records an `insert_row(position, new_row)`.
+        EditPlan& insert_row(const size_t position, const std::vector<T>& new_row) {
+            return record(edit_kind::INSERT_ROW, position, position, std::vector<T>(new_row), std::optional<T>());
+        }
+        // Records an `insert_row(position, new_row)`, moving from `new_row`.
+        EditPlan& insert_row(const size_t position, std::vector<T>&& new_row) {
+            return record(edit_kind::INSERT_ROW, position, position, std::move(new_row), std::optional<T>());
+        }
+        // Records an `insert_row(position, new_row)`.
+        EditPlan& insert_row(const size_t position, std::initializer_list<T> new_row) {
+            return record(edit_kind::INSERT_ROW, position, position, std::vector<T>(new_row), std::optional<T>());
+        }
+        // Records an `insertfill_row(position, fillvalue)`.
+        EditPlan& insertfill_row(const size_t position, const T& fillvalue) {
+            return record(edit_kind::INSERTFILL_ROW, position, position, std::vector<T>(), std::optional<T>(fillvalue));
+        }
+        // Records a `delete_row(i)`.
+        EditPlan& delete_row(const size_t i) {
+            return record(edit_kind::DELETE_ROWS, i, i+1, std::vector<T>(), std::optional<T>());
+        }
+        // Records a `delete_rows(i_start, i_past_end)`.
+        EditPlan& delete_rows(const size_t i_start, const size_t i_past_end) {
+            return record(edit_kind::DELETE_ROWS, i_start, i_past_end, std::vector<T>(), std::optional<T>());
+        }
+        // Records an `insert_col(position, new_col)`.
+        EditPlan& insert_col(const size_t position, const std::vector<T>& new_col) {
+            return record(edit_kind::INSERT_COL, position, position, std::vector<T>(new_col), std::optional<T>());
+        }
+        // Records an `insert_col(position, new_col)`, moving from `new_col`.
+        EditPlan& insert_col(const size_t position, std::vector<T>&& new_col) {
+            return record(edit_kind::INSERT_COL, position, position, std::move(new_col), std::optional<T>());
+        }
+        // Records an `insert_col(position, new_col)`.
+        EditPlan& insert_col(const size_t position, std::initializer_list<T> new_col) {
+            return record(edit_kind::INSERT_COL, position, position, std::vector<T>(new_col), std::optional<T>());
+        }
+        // Records an `insertfill_col(position, fillvalue)`.
+        EditPlan& insertfill_col(const size_t position, const T& fillvalue) {
+            return record(edit_kind::INSERTFILL_COL, position, position, std::vector<T>(), std::optional<T>(fillvalue));
+        }
+        // Records a `delete_col(j)`.
+        EditPlan& delete_col(const size_t j) {
+            return record(edit_kind::DELETE_COLS, j, j+1, std::vector<T>(), std::optional<T>());
+        }
+        // Records a `delete_cols(j_start, j_past_end)`.
+        EditPlan& delete_cols(const size_t j_start, const size_t j_past_end) {
+            return record(edit_kind::DELETE_COLS, j_start, j_past_end, std::vector<T>(), std::optional<T>());
+        }
+
+        // Number of edits recorded so far.
+        size_t size() const {
+            return edits.size();
+        }
+        // Returns `true` if no edits have been recorded.
+        bool empty() const {
+            return edits.empty();
+        }
+        // Forgets all recorded edits.
+        EditPlan& clear() {
+            edits.clear();
+            return *this;
+        }
+    };
+
+    // Applies every edit in `plan`, in order, in a single rebuild pass: each surviving element is moved exactly once, and each row's storage is allocated once.
+    // Throws the same errors as the corresponding single-edit methods would (`std::out_of_range` for bad positions, `std::length_error` for inserted rows/columns of the wrong length); the whole plan is checked before any change is made, so the array is left unchanged if it throws.
+    // Unlike `insert_row`, inserting a row into an array that has rows but no columns requires the new row to be empty, so the result is always rectangular.
+    Array2D& apply_edits(EditPlan&& plan) {
+        YELLE_ARRAY2D_OP("apply_edits");
+        using edit_kind = typename EditPlan::edit_kind;
+        normalize_origin();
+        const size_t orig_rows = rowCount();
+        const size_t orig_cols = colCount();
+
+        // Every row and column gets an id: original ones are numbered by their index, and inserted ones from `orig_rows`/`orig_cols` upwards, in order of insertion.
+        // An inserted line holds a value for exactly those crossing lines whose ids are below its `watermark`, i.e. that existed when it was inserted, in the order given by `crossing`.
+        // Consecutive inserts along one axis share a single snapshot of the crossing ids, taken afresh only once the crossing axis has changed, so e.g. hundreds of column inserts into a million-row array keep one copy of the row ids.
+        struct InsertedLine {
+            typename EditPlan::Edit* edit;  // `nullptr` for the columns implied by inserting a row into an empty array (and vice versa), which never hold data
+            std::shared_ptr<const std::vector<size_t>> crossing;   // ids of the crossing lines at the time of insertion (`nullptr` where the values aren't looked up by id)
+            size_t watermark;               // first crossing-line id assigned after this line was inserted
+            size_t cursor;                  // position within `crossing` while rebuilding
+        };
+        std::vector<size_t> rows(orig_rows);
+        std::vector<size_t> cols(orig_cols);
+        for (size_t i=0; i < orig_rows; ++i) {
+            rows[i] = i;
+        }
+        for (size_t j=0; j < orig_cols; ++j) {
+            cols[j] = j;
+        }
+        std::vector<InsertedLine> new_rows;
+        std::vector<InsertedLine> new_cols;
+        // current snapshots of `rows` and `cols`, reset whenever those change
+        std::shared_ptr<const std::vector<size_t>> rows_snapshot;
+        std::shared_ptr<const std::vector<size_t>> cols_snapshot;
+        // the shared snapshot of `ids`, taking a new one if `ids` has changed since the last
+        auto snapshot = [](std::shared_ptr<const std::vector<size_t>>& current, const std::vector<size_t>& ids) {
+            if (!current) {
+                current = std::make_shared<const std::vector<size_t>>(ids);
+            }
+            return current;
+        };
+
+        // replay the plan on the ids alone, validating as we go
+        for (typename EditPlan::Edit& edit : plan.edits) {
+            switch (edit.kind) {
+                case edit_kind::INSERT_ROW:
+                case edit_kind::INSERTFILL_ROW:
+                    if (edit.start > rows.size()) {
+                        fprintf(stderr, "Attempted to insert a row at index %zu into an array with only %zu rows!\n", edit.start, rows.size());
+                        throw std::out_of_range("tried to add row at too-high index value");
+                    }
+                    if (rows.empty() && edit.kind == edit_kind::INSERT_ROW) {
+                        // the first row decides how many columns there are
+                        cols.clear();
+                        cols_snapshot.reset();
+                        for (size_t k=0; k < edit.values.size(); ++k) {
+                            cols.push_back(orig_cols + new_cols.size());
+                            new_cols.push_back(InsertedLine{nullptr, nullptr, orig_rows + new_rows.size(), 0});
+                        }
+                    } else if (edit.kind == edit_kind::INSERT_ROW && edit.values.size() != cols.size()) {
+                        fprintf(stderr, "Attempted to insert a row of length %zu into an array with row-length %zu!\n", edit.values.size(), cols.size());
+                        throw std::length_error("tried to add row of incorrect length");
+                    }
+                    new_rows.push_back(InsertedLine{&edit, (edit.fill ? nullptr : snapshot(cols_snapshot, cols)), orig_cols + new_cols.size(), 0});
+                    rows.insert(rows.begin() + edit.start, orig_rows + new_rows.size() - 1);
+                    rows_snapshot.reset();
+                    break;
+
+                case edit_kind::DELETE_ROWS:
+                    if (edit.start >= rows.size() || edit.past_end > rows.size()) {
+                        fprintf(stderr, "Tried to delete rows [%zu,%zu) from an Array2D with %zu rows!\n", edit.start, edit.past_end, rows.size());
+                        throw std::out_of_range("cannot delete rows outside of valid range");
+                    }
+                    if (edit.start < edit.past_end) {
+                        rows.erase(rows.begin() + edit.start, rows.begin() + edit.past_end);
+                        rows_snapshot.reset();
+                    }
+                    // an array without rows has no columns either
+                    if (rows.empty()) {
+                        cols.clear();
+                        cols_snapshot.reset();
+                    }
+                    break;
+
+                case edit_kind::INSERT_COL:
+                case edit_kind::INSERTFILL_COL:
+                    if (edit.start > cols.size()) {
+                        fprintf(stderr, "Attempted to insert a column at index %zu into an array with only %zu columns!\n", edit.start, cols.size());
+                        throw std::out_of_range("tried to add column at too-high index value");
+                    }
+                    if (rows.empty()) {
+                        if (edit.kind == edit_kind::INSERTFILL_COL || edit.values.empty()) {
+                            // same as `insert_col`/`insertfill_col` on an empty array: nothing to add
+                            break;
+                        }
+                        // the first column decides how many rows there are
+                        for (size_t k=0; k < edit.values.size(); ++k) {
+                            rows.push_back(orig_rows + new_rows.size());
+                            new_rows.push_back(InsertedLine{nullptr, nullptr, orig_cols + new_cols.size(), 0});
+                        }
+                        rows_snapshot.reset();
+                    } else if (edit.kind == edit_kind::INSERT_COL && edit.values.size() != rows.size()) {
+                        fprintf(stderr, "Attempted to insert a column of length %zu into an array with column-length %zu!\n", edit.values.size(), rows.size());
+                        throw std::length_error("tried to add column of incorrect length");
+                    }
+                    new_cols.push_back(InsertedLine{&edit, (edit.fill ? nullptr : snapshot(rows_snapshot, rows)), orig_rows + new_rows.size(), 0});
+                    cols.insert(cols.begin() + edit.start, orig_cols + new_cols.size() - 1);
+                    cols_snapshot.reset();
+                    break;
+
+                case edit_kind::DELETE_COLS:
+                    if (edit.start >= cols.size() || edit.past_end > cols.size()) {
+                        fprintf(stderr, "Tried to delete columns [%zu,%zu) from an Array2D with %zu columns!\n", edit.start, edit.past_end, cols.size());
+                        throw std::out_of_range("cannot delete columns outside of valid range");
+                    }
+                    if (edit.start < edit.past_end) {
+                        cols.erase(cols.begin() + edit.start, cols.begin() + edit.past_end);
+                        cols_snapshot.reset();
+                    }
+                    break;
+            }
+        }
+
+        // Takes the next value of inserted line `line` for the crossing line `crossing_id`.
+        // Insertions and deletions never reorder the surviving lines, so each line's `cursor` only ever moves forwards.
+        auto take = [](InsertedLine& line, const size_t crossing_id) -> T {
+            if (line.edit->fill) {
+                return *(line.edit->fill);
+            }
+            while ((*line.crossing)[line.cursor] != crossing_id) {
+                ++line.cursor;
+            }
+            return std::move(line.edit->values[line.cursor++]);
+        };
+
+        // rebuild: every cell comes from an original row, from an inserted row, or from an inserted column, whichever was inserted last
+        std::vector<std::vector<T>> rebuilt;
+        rebuilt.reserve(rows.size());
+        // (cells taken from `insertfill_*` edits are really copies)
+        YELLE_ARRAY2D_ELEMENTS(0, rows.size() * cols.size());
+        for (const size_t r : rows) {
+            rebuilt.emplace_back();
+            std::vector<T>& newRow = rebuilt.back();
+            newRow.reserve(std::max(reserved_cols, cols.size()));
+            InsertedLine* inserted_row = (r < orig_rows ? nullptr : &new_rows[r - orig_rows]);
+            for (const size_t c : cols) {
+                if (inserted_row != nullptr && c < inserted_row->watermark) {
+                    newRow.push_back(take(*inserted_row, c));
+                } else if (c >= orig_cols) {
+                    newRow.push_back(take(new_cols[c - orig_cols], r));
+                } else {
+                    newRow.push_back(std::move(array[r][c]));
+                }
+            }
+        }
+        array.swap(rebuilt);
+        return *this;
+    }
+
+    // Applies a copy of every edit in `plan`; see the `EditPlan&&` overload.
+    Array2D& apply_edits(const EditPlan& plan) {
+        return apply_edits(EditPlan(plan));
+    }
+
     /* ============================
         Full Array Access by Iterator
             These iterators are invalid (pointing to NULL) if the array is empty.
@@ -1325,9 +2658,9 @@ public:
     // Incrementing this iterator goes to the next element of the same row, or--if already at the end of the row--to position 0 in the next row.
     EntireIterator begin() {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::FORWARD);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::FORWARD);
         } else {
-            return EntireIterator(this, &(array[0][0]), colCount(), iterator_direction::FORWARD);
+            return EntireIterator(this, 0, 0, colCount(), iterator_direction::FORWARD);
         }
     }
 
@@ -1335,9 +2668,9 @@ public:
     // Incrementing this iterator goes to the next element of the same row, or--if already at the end of the row--to position 0 in the next row.
     const EntireIterator cbegin() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::FORWARD);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::FORWARD);
         } else {
-            return EntireIterator(this, const_cast<T*>(&(array[0][0])), colCount(), iterator_direction::FORWARD);
+            return EntireIterator(this, 0, 0, colCount(), iterator_direction::FORWARD);
         }
     }
 
@@ -1345,9 +2678,9 @@ public:
     // Equal to `begin() + size()`.
     EntireIterator end() {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::FORWARD);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::FORWARD);
         } else {
-            return EntireIterator(this, &(array[rowCount()][0]), colCount(), iterator_direction::FORWARD);
+            return EntireIterator(this, static_cast<long>(rowCount()), 0, colCount(), iterator_direction::FORWARD);
         }
     }
 
@@ -1355,9 +2688,9 @@ public:
     // Equal to `cbegin() + size()`.
     const EntireIterator cend() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::FORWARD);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::FORWARD);
         } else {
-            return EntireIterator(this, const_cast<T*>(&(array[rowCount()][0])), colCount(), iterator_direction::FORWARD);
+            return EntireIterator(this, static_cast<long>(rowCount()), 0, colCount(), iterator_direction::FORWARD);
         }
     }
 
@@ -1365,9 +2698,9 @@ public:
     // Incrementing this iterator goes to the previous element of the row, or--if already at the start of the row--to position `colCount` in the previous row.
     EntireIterator rbegin() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::REVERSED);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::REVERSED);
         } else {
-            return EntireIterator(this, &(array[rowCount()-1][colCount()-1]), colCount(), iterator_direction::REVERSED);
+            return EntireIterator(this, static_cast<long>(rowCount())-1, static_cast<long>(colCount())-1, colCount(), iterator_direction::REVERSED);
         }
     }
 
@@ -1375,9 +2708,9 @@ public:
     // Incrementing this iterator goes to the previous element of the row, or--if already at the start of the row--to position `colCount` in the previous row.
     const EntireIterator crbegin() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::REVERSED);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::REVERSED);
         } else {
-            return EntireIterator(this, const_cast<T*>(&(array[rowCount()-1][colCount()-1])), colCount(), iterator_direction::REVERSED);
+            return EntireIterator(this, static_cast<long>(rowCount())-1, static_cast<long>(colCount())-1, colCount(), iterator_direction::REVERSED);
         }
     }
 
@@ -1385,9 +2718,9 @@ public:
     // Equal to `rbegin() + size()`.
     EntireIterator rend() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::REVERSED);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::REVERSED);
         } else {
-            return EntireIterator(this, &(array[-1][colCount()-1]), colCount(), iterator_direction::REVERSED);
+            return EntireIterator(this, -1, static_cast<long>(colCount())-1, colCount(), iterator_direction::REVERSED);
         }
     }
 
@@ -1395,9 +2728,9 @@ public:
     // Equal to `crbegin() + size()`.
     const EntireIterator crend() const {
         if (empty()) {
-            return EntireIterator(nullptr, nullptr, 0, iterator_direction::REVERSED);
+            return EntireIterator(nullptr, 0, 0, 0, iterator_direction::REVERSED);
         } else {
-            return EntireIterator(this, const_cast<T*>(&(array[-1][colCount()-1])), colCount(), iterator_direction::REVERSED);
+            return EntireIterator(this, -1, static_cast<long>(colCount())-1, colCount(), iterator_direction::REVERSED);
         }
     }
 
@@ -1411,7 +2744,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, &(array[0][fixed_col_j]), fixed_col_j, iterator_direction::FORWARD);
+            return ColumnIterator(this, 0, fixed_col_j, iterator_direction::FORWARD);
         }
     }
 
@@ -1421,7 +2754,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, const_cast<T*>(&(array[0][fixed_col_j])), fixed_col_j, iterator_direction::FORWARD);
+            return ColumnIterator(this, 0, fixed_col_j, iterator_direction::FORWARD);
         }
     }
 
@@ -1431,7 +2764,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, &(array[rowCount()][fixed_col_j]), fixed_col_j, iterator_direction::FORWARD);
+            return ColumnIterator(this, static_cast<long>(rowCount()), fixed_col_j, iterator_direction::FORWARD);
         }
     }
 
@@ -1441,7 +2774,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, const_cast<T*>(&(array[rowCount()][fixed_col_j])), fixed_col_j, iterator_direction::FORWARD);
+            return ColumnIterator(this, static_cast<long>(rowCount()), fixed_col_j, iterator_direction::FORWARD);
         }
     }
 
@@ -1451,7 +2784,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, &(array[rowCount()-1][fixed_col_j]), fixed_col_j, iterator_direction::REVERSED);
+            return ColumnIterator(this, static_cast<long>(rowCount())-1, fixed_col_j, iterator_direction::REVERSED);
         }
     }
 
@@ -1461,7 +2794,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, const_cast<T*>(&(array[rowCount()-1][fixed_col_j])), fixed_col_j, iterator_direction::REVERSED);
+            return ColumnIterator(this, static_cast<long>(rowCount())-1, fixed_col_j, iterator_direction::REVERSED);
         }
     }
 
@@ -1471,7 +2804,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, &(array[-1][fixed_col_j]), fixed_col_j, iterator_direction::REVERSED);
+            return ColumnIterator(this, -1, fixed_col_j, iterator_direction::REVERSED);
         }
     }
 
@@ -1481,7 +2814,7 @@ public:
         if (fixed_col_j >= colCount()) {
             throw std::out_of_range("column index out of range");
         } else {
-            return ColumnIterator(this, const_cast<T*>(&(array[-1][fixed_col_j])), fixed_col_j, iterator_direction::REVERSED);
+            return ColumnIterator(this, -1, fixed_col_j, iterator_direction::REVERSED);
         }
     }
 
@@ -1490,7 +2823,9 @@ public:
     ============================= */
 
     // Creates a deep copy of this Array2D, for usage in method-chaining.
+    // For many cheap branches off one large array, see `CowArray2D` (in `cow_array2d.hpp`), whose copies share storage until written to.
     Array2D clone() const {
+        YELLE_ARRAY2D_OP("clone");
         return Array2D(*this);
     }
 
@@ -1498,46 +2833,56 @@ public:
     // Given a lambda function or function pointer from type `T` to `S`, creates and returns a new `Array2D` of type `S` whose elements are equal to `func(t)` for each corresponding `t` in the input array.
     template <class S>
     Array2D<S> map(const std::function<S(T)>& func) const {
+        YELLE_ARRAY2D_OP("map");
         Array2D<S> outArray;
-        std::vector<S> temp_row;
-
-        for (size_t i=0; i < rowCount(); ++i) {
-            temp_row.clear();
-            for (size_t j=0; j < colCount(); ++j) {
-                temp_row.push_back(func(array[i][j]));
-            }
-            outArray.append_row(std::move(temp_row));
-        }
+        impl_map_into(outArray, func);
         return outArray;
     }
 
+    // Like `map`, but writes the results into `out` instead of a new array, and returns `out`.
+    // If `out` already has this array's dimensions its elements are simply overwritten; otherwise it is reshaped first, reusing its rows' capacity. Either way, calling this repeatedly with the same `out` allocates nothing after the first call.
+    template <class S>
+    Array2D<S>& map_into(Array2D<S>& out, const std::function<S(T)>& func) const {
+        YELLE_ARRAY2D_OP("map_into");
+        return impl_map_into(out, func);
+    }
+
     // Map a binary function onto this Array2D<T> and one other Array2D<T2>, returning a new array and leaving the original unchanged.
     // Given a lambda function or function pointer from type `(T,T2)` to `S`, creates and returns a new `Array2D` of type `S` whose elements are equal to `func(t,t2)` for each corresponding `t,t2` in the input arrays.
+    // The arrays may also differ in shape as in NumPy: a `1 x C` row vector, an `R x 1` column vector, or a `1 x 1` array (on either side) is broadcast across the other without being copied, so e.g. a column of per-row scales can be applied directly to a whole array.
+    // Throws `std::length_error` if the dimensions are otherwise different.
     template <class S, class T2>
-    Array2D<S> map2(const std::function<S(T,T2)&> func, const Array2D<T2>& arr2) const {
+    Array2D<S> map2(const std::function<S(T,T2)>& func, const Array2D<T2>& arr2) const {
+        YELLE_ARRAY2D_OP("map2");
         Array2D<S> outArray;
-        std::vector<S> temp_row;
+        map2_into(outArray, func, arr2);
+        return outArray;
+    }
 
-        for (size_t i=0; i < rowCount(); ++i) {
-            temp_row.clear();
-            for (size_t j=0; j < colCount(); ++j) {
-                temp_row.push_back(func(array[i][j], arr2.array[i][j]));
-            }
-            outArray.append_row(std::move(temp_row));
+    // Like `map2`, but writes the results into `out` (which may be either input) instead of a new array, and returns `out`. Reuses `out`'s storage in the same way as `map_into`.
+    template <class S, class T2>
+    Array2D<S>& map2_into(Array2D<S>& out, const std::function<S(T,T2)>& func, const Array2D<T2>& arr2) const {
+        YELLE_ARRAY2D_OP("map2_into");
+        if (!broadcast_dim(rowCount(), arr2.rowCount()) || !broadcast_dim(colCount(), arr2.colCount())) {
+            fprintf(stderr, "Attempted to map2 an array of dimension (%zu,%zu) with one of dimension (%zu,%zu)!\n", rowCount(), colCount(), arr2.rowCount(), arr2.colCount());
+            throw std::length_error("called map2 on Array2D objects of incompatible dimensions");
         }
-        return outArray;
+        return impl_map2_into(out, func, arr2);
     }
 
     // Map a unary function of type `T -> T` onto this Array2D, changing each value in-place.
     // Given a lambda function or function pointer from type `T` to `T`, applies the function in-place to each element of this array.
     Array2D& map_inplace(const std::function<T(T)>& func) {
+        YELLE_ARRAY2D_OP("map_inplace");
         // tiny optimization, since this isn't a const method
         const size_t row_ct = rowCount();
         const size_t col_ct = colCount();
 
         for (size_t i=0; i < row_ct; ++i) {
+            std::vector<T>& thisRow = array[phys_row(i)];
             for (size_t j=0; j < col_ct; ++j) {
-                array[i][j] = func(array[i][j]);
+                T& elem = thisRow[phys_col(j)];
+                elem = func(elem);
             }
         }
         return *this;
@@ -1549,73 +2894,157 @@ public:
 
 protected:
     // Boilerplate code for implementing unary operators.
-    Array2D impl_operator1(const std::function<T(const T&)> op) const {
-        const size_t row_ct = rowCount();
-        const size_t col_ct = colCount();
+    template <class Op>
+    Array2D impl_operator1(const Op op) const {
+        YELLE_ARRAY2D_OP("impl_operator1");
         Array2D new2D;
-        new2D.array.reserve(row_ct);
-        for (size_t i=0; i < row_ct; ++i) {
-            new2D.array.emplace_back();
-            new2D.array[i].reserve(col_ct);
-            for (size_t j=0; j < col_ct; ++j) {
-                new2D.array[i].push_back(op(array[i][j]));
+        impl_map_into(new2D, op);
+        return new2D;
+    }
+
+    // Boilerplate code for implementing unary operators on temporaries: applies `op` to each element in-place.
+    template <class Op>
+    Array2D& impl_operator1_inplace(const Op op) {
+        YELLE_ARRAY2D_OP("impl_operator1_inplace");
+        for (std::vector<T>& row : array) {
+            for (T& elem : row) {
+                elem = op(elem);
             }
         }
-        return new2D;
+        return *this;
     }
 
 public:
-    Array2D operator!() const {
+    Array2D operator!() const& {
         std::logical_not<T> op;
         return impl_operator1(op);
     }
 
-    Array2D operator-() const {
+    Array2D operator-() const& {
         std::negate<T> op;
         return impl_operator1(op);
     }
 
+    // On a temporary (e.g. `-(a + b)`), the unary operators work in-place and hand its storage on, instead of allocating a new array.
+    Array2D operator!() && {
+        std::logical_not<T> op;
+        return std::move(impl_operator1_inplace(op));
+    }
+
+    Array2D operator-() && {
+        std::negate<T> op;
+        return std::move(impl_operator1_inplace(op));
+    }
+
+    // Out-parameter forms of the unary operators: write the result into `out` (which may be this array) and return it, reusing `out`'s storage as in `map_into`.
+    Array2D& logical_not_into(Array2D& out) const {
+        YELLE_ARRAY2D_OP("logical_not_into");
+        std::logical_not<T> op;
+        return impl_map_into(out, op);
+    }
+
+    Array2D& negate_into(Array2D& out) const {
+        YELLE_ARRAY2D_OP("negate_into");
+        std::negate<T> op;
+        return impl_map_into(out, op);
+    }
+
     /* ============================
         Binary Operators
     ============================= */
     // Boilerplate code for implementing binary operators.
     // Allows a binary operator to work with Array2D + Array2D, etc.
-    Array2D impl_operator2(const std::function<T(const T&, const T&)> op, const Array2D& other) const {
-        const size_t row_ct = rowCount();
-        const size_t col_ct = colCount();
-        if (row_ct != other.rowCount() || col_ct != other.colCount()) {
-            throw std::length_error("called boolean operator on Array2D objects of unequal dimension");
-        }
+    template <class Op>
+    Array2D impl_operator2(const Op op, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("impl_operator2");
         Array2D new2D;
-        new2D.array.reserve(row_ct);
-        for (size_t i=0; i < row_ct; ++i) {
-            new2D.array.emplace_back();
-            new2D.array[i].reserve(col_ct);
-            for (size_t j=0; j < col_ct; ++j) {
-                new2D.array[i].push_back(op(array[i][j], other.array[i][j]));
-            }
-        }
-
+        impl_operator2_into(new2D, op, other);
         return new2D;
     }
 
     // Boilerplate code for implementing binary operators.
     // Allows a binary operator to work with Array2D + T, etc.
-    Array2D impl_operator2(const std::function<T(const T&, const T&)> op, const T& other) const {
+    template <class Op>
+    Array2D impl_operator2(const Op op, const T& other) const {
+        YELLE_ARRAY2D_OP("impl_operator2");
+        Array2D new2D;
+        impl_operator2_into(new2D, op, other);
+        return new2D;
+    }
+
+    // Boilerplate code for the binary operators and their out-parameter forms, writing into `out` (which may be either operand).
+    template <class Op>
+    Array2D& impl_operator2_into(Array2D& out, const Op op, const Array2D& other) const {
+        if (!broadcast_dim(rowCount(), other.rowCount()) || !broadcast_dim(colCount(), other.colCount())) {
+            throw std::length_error("called boolean operator on Array2D objects of incompatible dimensions");
+        }
+        return impl_map2_into(out, op, other);
+    }
+
+    // Boilerplate code for the binary operators on a temporary left operand: works in-place when the result has the temporary's own dimensions (i.e. unless it is itself being broadcast).
+    template <class Op>
+    Array2D impl_operator2_reuse(const Op op, const Array2D& other) {
+        if (broadcast_dim(rowCount(), other.rowCount()) == rowCount() && broadcast_dim(colCount(), other.colCount()) == colCount()) {
+            return std::move(impl_compound(op, other));
+        }
+        return impl_operator2(op, other);
+    }
+
+    template <class Op>
+    Array2D& impl_operator2_into(Array2D& out, const Op op, const T& other) const {
+        // copied first, since `other` may be one of `out`'s own elements
+        const T value = other;
+        return impl_map_into(out, [&op, &value](const T& elem) { return op(elem, value); });
+    }
+
+    // Boilerplate code for implementing compound assignment operators.
+    // Allows a binary operator to work in-place with Array2D += Array2D, etc., where `other` may also be a `1 x C` row, `R x 1` column, or `1 x 1` array to broadcast across this one.
+    template <class Op>
+    Array2D& impl_compound(const Op op, const Array2D& other) {
+        YELLE_ARRAY2D_OP("impl_compound");
         const size_t row_ct = rowCount();
         const size_t col_ct = colCount();
-
-        Array2D new2D;
-        new2D.array.reserve(row_ct);
+        if (broadcast_dim(row_ct, other.rowCount()) != row_ct || broadcast_dim(col_ct, other.colCount()) != col_ct) {
+            throw std::length_error("called compound assignment on Array2D objects of incompatible dimensions");
+        }
+        const bool other_rows = (other.rowCount() == row_ct);
+        const bool other_cols = (other.colCount() == col_ct);
         for (size_t i=0; i < row_ct; ++i) {
-            new2D.array.emplace_back();
-            new2D.array[i].reserve(col_ct);
-            for (size_t j=0; j < col_ct; ++j) {
-                new2D.array[i].push_back(op(array[i][j], other));
+            std::vector<T>& thisRow = array[phys_row(i)];
+            const std::vector<T>& otherRow = other.array[other.phys_row(other_rows ? i : 0)];
+            if (!other_cols) {
+                const T value = otherRow[0];
+                for (T& elem : thisRow) {
+                    elem = op(elem, value);
+                }
+            } else if (col_origin == 0 && other.col_origin == 0) {
+                // common case: no column shift pending on either side, so this is a plain loop over two contiguous rows
+                for (size_t j=0; j < col_ct; ++j) {
+                    thisRow[j] = op(thisRow[j], otherRow[j]);
+                }
+            } else {
+                for (size_t j=0; j < col_ct; ++j) {
+                    T& elem = thisRow[phys_col(j)];
+                    elem = op(elem, otherRow[other.phys_col(j)]);
+                }
             }
         }
+        return *this;
+    }
 
-        return new2D;
+    // Boilerplate code for implementing compound assignment operators.
+    // Allows a binary operator to work in-place with Array2D += T, etc.
+    template <class Op>
+    Array2D& impl_compound(const Op op, const T& other) {
+        YELLE_ARRAY2D_OP("impl_compound");
+        // copied first, since `other` may well be one of this array's own elements (e.g. `arr -= arr[0][0]`)
+        const T value = other;
+        for (std::vector<T>& row : array) {
+            for (T& elem : row) {
+                elem = op(elem, value);
+            }
+        }
+        return *this;
     }
 
     /* ----- OPERATORS ON OTHER ARRAYS ----- */
@@ -1653,27 +3082,99 @@ public:
     //     return impl_operator2(op, other);
     // }
 
-    Array2D operator+(const Array2D& other) const {
+    Array2D operator+(const Array2D& other) const& {
         std::plus<T> op;
         return impl_operator2(op, other);
     }
-    Array2D operator-(const Array2D& other) const {
+    Array2D operator-(const Array2D& other) const& {
         std::minus<T> op;
         return impl_operator2(op, other);
     }
-    Array2D operator*(const Array2D& other) const {
+    Array2D operator*(const Array2D& other) const& {
         std::multiplies<T> op;
         return impl_operator2(op, other);
     }
-    Array2D operator/(const Array2D& other) const {
+    Array2D operator/(const Array2D& other) const& {
         std::divides<T> op;
         return impl_operator2(op, other);
     }
-    Array2D operator%(const Array2D& other) const {
+    Array2D operator%(const Array2D& other) const& {
         std::modulus<T> op;
         return impl_operator2(op, other);
     }
 
+    // The binary operators broadcast like `map2`: e.g. `arr - col_means`, with `col_means` a `1 x C` row vector, subtracts each column's mean without building a full-size array of them.
+    // Compound assignment works in-place, without allocating; there only the right-hand side may be broadcast. Both throw `std::length_error` if the dimensions are incompatible.
+    // When the left operand is a temporary (as in every step of `a + b + c + d` after the first), the result takes over its storage in the same way, so the whole chain allocates just once.
+    Array2D& operator+=(const Array2D& other) {
+        std::plus<T> op;
+        return impl_compound(op, other);
+    }
+    Array2D& operator-=(const Array2D& other) {
+        std::minus<T> op;
+        return impl_compound(op, other);
+    }
+    Array2D& operator*=(const Array2D& other) {
+        std::multiplies<T> op;
+        return impl_compound(op, other);
+    }
+    Array2D& operator/=(const Array2D& other) {
+        std::divides<T> op;
+        return impl_compound(op, other);
+    }
+    Array2D& operator%=(const Array2D& other) {
+        std::modulus<T> op;
+        return impl_compound(op, other);
+    }
+
+    Array2D operator+(const Array2D& other) && {
+        std::plus<T> op;
+        return impl_operator2_reuse(op, other);
+    }
+    Array2D operator-(const Array2D& other) && {
+        std::minus<T> op;
+        return impl_operator2_reuse(op, other);
+    }
+    Array2D operator*(const Array2D& other) && {
+        std::multiplies<T> op;
+        return impl_operator2_reuse(op, other);
+    }
+    Array2D operator/(const Array2D& other) && {
+        std::divides<T> op;
+        return impl_operator2_reuse(op, other);
+    }
+    Array2D operator%(const Array2D& other) && {
+        std::modulus<T> op;
+        return impl_operator2_reuse(op, other);
+    }
+
+    // Out-parameter forms of `+ - * / %`: `a.add_into(out, b)` computes `a + b` into `out` (which may be `a` or `b`) and returns it, reusing `out`'s storage as in `map_into`, so that steady-state loops allocate nothing.
+    Array2D& add_into(Array2D& out, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("add_into");
+        std::plus<T> op;
+        return impl_operator2_into(out, op, other);
+    }
+    Array2D& subtract_into(Array2D& out, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("subtract_into");
+        std::minus<T> op;
+        return impl_operator2_into(out, op, other);
+    }
+    Array2D& multiply_into(Array2D& out, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("multiply_into");
+        std::multiplies<T> op;
+        return impl_operator2_into(out, op, other);
+    }
+    Array2D& divide_into(Array2D& out, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("divide_into");
+        std::divides<T> op;
+        return impl_operator2_into(out, op, other);
+    }
+    Array2D& modulo_into(Array2D& out, const Array2D& other) const {
+        YELLE_ARRAY2D_OP("modulo_into");
+        std::modulus<T> op;
+        return impl_operator2_into(out, op, other);
+    }
+
     /* ----- OPERATORS ON SINGLE <T>-TYPES ----- */
 
     // Array2D operator==(const T& other_val) const {
@@ -1709,27 +3210,96 @@ public:
     //     return impl_operator2(op, other_val);
     // }
 
-    Array2D operator+(const T& other_val) const {
+    Array2D operator+(const T& other_val) const& {
         std::plus<T> op;
         return impl_operator2(op, other_val);
     }
-    Array2D operator-(const T& other_val) const {
+    Array2D operator-(const T& other_val) const& {
         std::minus<T> op;
         return impl_operator2(op, other_val);
     }
-    Array2D operator*(const T& other_val) const {
+    Array2D operator*(const T& other_val) const& {
         std::multiplies<T> op;
         return impl_operator2(op, other_val);
     }
-    Array2D operator/(const T& other_val) const {
+    Array2D operator/(const T& other_val) const& {
         std::divides<T> op;
         return impl_operator2(op, other_val);
     }
-    Array2D operator%(const T& other_val) const {
+    Array2D operator%(const T& other_val) const& {
         std::modulus<T> op;
         return impl_operator2(op, other_val);
     }
 
+    // As with arrays, compound assignment with a single value works in-place, and so does the operator itself on a temporary (e.g. `(a - b) * 2`).
+    Array2D& operator+=(const T& other_val) {
+        std::plus<T> op;
+        return impl_compound(op, other_val);
+    }
+    Array2D& operator-=(const T& other_val) {
+        std::minus<T> op;
+        return impl_compound(op, other_val);
+    }
+    Array2D& operator*=(const T& other_val) {
+        std::multiplies<T> op;
+        return impl_compound(op, other_val);
+    }
+    Array2D& operator/=(const T& other_val) {
+        std::divides<T> op;
+        return impl_compound(op, other_val);
+    }
+    Array2D& operator%=(const T& other_val) {
+        std::modulus<T> op;
+        return impl_compound(op, other_val);
+    }
+
+    Array2D operator+(const T& other_val) && {
+        std::plus<T> op;
+        return std::move(impl_compound(op, other_val));
+    }
+    Array2D operator-(const T& other_val) && {
+        std::minus<T> op;
+        return std::move(impl_compound(op, other_val));
+    }
+    Array2D operator*(const T& other_val) && {
+        std::multiplies<T> op;
+        return std::move(impl_compound(op, other_val));
+    }
+    Array2D operator/(const T& other_val) && {
+        std::divides<T> op;
+        return std::move(impl_compound(op, other_val));
+    }
+    Array2D operator%(const T& other_val) && {
+        std::modulus<T> op;
+        return std::move(impl_compound(op, other_val));
+    }
+
+    Array2D& add_into(Array2D& out, const T& other_val) const {
+        YELLE_ARRAY2D_OP("add_into");
+        std::plus<T> op;
+        return impl_operator2_into(out, op, other_val);
+    }
+    Array2D& subtract_into(Array2D& out, const T& other_val) const {
+        YELLE_ARRAY2D_OP("subtract_into");
+        std::minus<T> op;
+        return impl_operator2_into(out, op, other_val);
+    }
+    Array2D& multiply_into(Array2D& out, const T& other_val) const {
+        YELLE_ARRAY2D_OP("multiply_into");
+        std::multiplies<T> op;
+        return impl_operator2_into(out, op, other_val);
+    }
+    Array2D& divide_into(Array2D& out, const T& other_val) const {
+        YELLE_ARRAY2D_OP("divide_into");
+        std::divides<T> op;
+        return impl_operator2_into(out, op, other_val);
+    }
+    Array2D& modulo_into(Array2D& out, const T& other_val) const {
+        YELLE_ARRAY2D_OP("modulo_into");
+        std::modulus<T> op;
+        return impl_operator2_into(out, op, other_val);
+    }
+
 };  // end class
 
 // Returns `true` if every element of the array maps via `boolifier` to `true`.
@@ -1758,7 +3328,8 @@ template <class T> bool any(const Array2D<T>& myarray, const std::function<bool(
 };  // end namespace
 #endif
 
-
+// The demo below is skipped when this file is pulled in by one of the companion headers (e.g. `stencil2d.hpp`), so that it can be included alongside user code that has its own `main`.
+#ifndef YELLE_ARRAY2D_NO_DEMO
 int main() {
     using namespace yelle;
     // constructor from nested initializer list (among several other constructors)
@@ -1838,3 +3409,4 @@ int main() {
 
     return 0;
 }
+#endif
@@ -0,0 +1,502 @@
+// Benchmark suite for Array2D. Build and run with e.g.
+//     g++ -std=c++17 -O2 -o array2d_bench array2d_bench.cpp
+//     ./array2d_bench --max-side 4096 --json results.json
+// Options:
+//     --max-side N     largest side length to run (sizes are the powers of 4 from 16 up to 16384; default 1024)
+//     --min-time MS    minimum time spent timing each case (default 100)
+//     --types LIST     comma-separated element types, out of char,int,double,string (default all)
+//     --filter TEXT    only run cases whose "family/name" contains TEXT
+//     --json PATH      also write all results to PATH as JSON
+//     --quiet          don't print each case as it finishes
+//     --no-counters    don't read hardware performance counters (cycles, instructions, L1D/LLC/dTLB misses, branch misses)
+//                      which are otherwise read on Linux wherever `perf_event_open` is permitted, and left out elsewhere
+
+#include "array2d_bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+// Every heap allocation in the program goes through here, so that the harness can report allocations per iteration.
+// (GCC can't tell that these replace the global operators, and would warn about `free`ing what `operator new` returned.)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t bytes) {
+    yelle::bench::count_allocation(bytes);
+    if (void* ptr = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace yelle;
+using namespace yelle::bench;
+
+// A deterministic, varied element for position `k`.
+template <class T>
+T make_value(const size_t k) {
+    if constexpr (std::is_same<T, std::string>::value) {
+        return std::to_string(k % 1000);
+    } else {
+        return static_cast<T>(k % 100 + 1);
+    }
+}
+
+template <class T>
+std::vector<std::vector<T>> make_rows(const size_t rows, const size_t cols) {
+    std::vector<std::vector<T>> out(rows);
+    for (size_t i=0; i < rows; ++i) {
+        out[i].reserve(cols);
+        for (size_t j=0; j < cols; ++j) {
+            out[i].push_back(make_value<T>(i*cols + j));
+        }
+    }
+    return out;
+}
+
+template <class T>
+Array2D<T> make_grid(const size_t rows, const size_t cols) {
+    return Array2D<T>(make_rows<T>(rows, cols));
+}
+
+// Runs every Array2D case for element type `T` on an `n` x `n` array.
+template <class T>
+void bench_array2d(BenchHarness& harness, const std::string& type, const size_t n) {
+    constexpr bool arithmetic = std::is_arithmetic<T>::value;
+    const double E = static_cast<double>(n * n * sizeof(T));    // bytes of element data in one array
+    const T value = make_value<T>(7);
+
+    /* ----- constructors and builders ----- */
+    {
+        Array2D<T> a;
+        harness.run("construct", "fill", type, n, n, E, [&]() {
+            a.fill(n, n, value);
+            keep(a);
+        });
+    }
+    {
+        const std::vector<std::vector<T>> src = make_rows<T>(n, n);
+        harness.run("construct", "vec_of_vecs_ctor", type, n, n, 2*E, [&]() {
+            Array2D<T> a(src);
+            keep(a);
+        });
+    }
+    {
+        const Array2D<T> a = make_grid<T>(n, n);
+        harness.run("construct", "clone", type, n, n, 2*E, [&]() {
+            Array2D<T> b = a.clone();
+            keep(b);
+        });
+    }
+    if constexpr (std::is_same<T, char>::value) {
+        std::string text;
+        for (size_t i=0; i < n; ++i) {
+            text.append(n, 'x');
+            text.push_back('\n');
+        }
+        Array2D<T> a;
+        harness.run("construct", "build_from_string", type, n, n, 2*E, [&]() {
+            a.build_from_string(text, [](char c) { return c; });
+            keep(a);
+        });
+    }
+
+    /* ----- transpose / rotate / flip ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        harness.run("transpose", "transpose", type, n, n, 2*E, [&]() {
+            a.transpose();
+            keep(a);
+        });
+        harness.run("transpose", "rotateCW", type, n, n, 2*E, [&]() {
+            a.rotateCW();
+            keep(a);
+        });
+        harness.run("transpose", "flip_horizontal", type, n, n, 2*E, [&]() {
+            a.flip_horizontal();
+            keep(a);
+        });
+        // only swaps whole rows, so no element data is moved
+        harness.run("transpose", "flip_vertical", type, n, n, 0, [&]() {
+            a.flip_vertical();
+            keep(a);
+        });
+    }
+
+    /* ----- shifts ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        harness.run("shift", "shift_horizontal", type, n, n, 0, [&]() {
+            a.shift_horizontal(1);
+            keep(a);
+        });
+        harness.run("shift", "shift_vertical", type, n, n, 0, [&]() {
+            a.shift_vertical(1);
+            keep(a);
+        });
+        harness.run("shift", "shift_horizontal_fill", type, n, n, static_cast<double>(n * sizeof(T)), [&]() {
+            a.shift_horizontal_fill(1, value);
+            keep(a);
+        });
+        harness.run("shift", "shift_vertical_fill", type, n, n, static_cast<double>(n * sizeof(T)), [&]() {
+            a.shift_vertical_fill(1, value);
+            keep(a);
+        });
+        harness.run("shift", "shift_horizontal_fill(n/4)", type, n, n, static_cast<double>((n / 4) * n * sizeof(T)), [&]() {
+            a.shift_horizontal_fill(static_cast<long>(n / 4), value);
+            keep(a);
+        });
+    }
+
+    /* ----- insert / delete ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        const std::vector<T> line(n, value);
+        harness.run("insert/delete", "insert_row+delete_row", type, n, n, static_cast<double>(2 * n * sizeof(T)), [&]() {
+            a.insert_row(n / 2, line);
+            a.delete_row(n / 2);
+            keep(a);
+        });
+        harness.run("insert/delete", "insert_col+delete_col", type, n, n, 2*E, [&]() {
+            a.insert_col(n / 2, line);
+            a.delete_col(n / 2);
+            keep(a);
+        });
+        // the shift leaves a column origin behind, which the insert has to undo first
+        harness.run("insert/delete", "shift_horizontal(n/3)+insert_col+delete_col", type, n, n, 3*E, [&]() {
+            a.shift_horizontal(static_cast<long>(n / 3));
+            a.insert_col(n / 2, line);
+            a.delete_col(n / 2);
+            keep(a);
+        });
+        typename Array2D<T>::EditPlan plan;
+        plan.insertfill_row(0, value).delete_row(n - 1).insertfill_col(0, value).delete_col(n - 1);
+        harness.run("insert/delete", "apply_edits", type, n, n, 2*E, [&]() {
+            a.apply_edits(plan);
+            keep(a);
+        });
+    }
+
+    /* ----- resizing ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        harness.run("resize", "safe_resize_topleft(+8,-8)", type, n, n, 2*E, [&]() {
+            a.safe_resize_topleft(n + 8, n + 8, value);
+            a.safe_resize_topleft(n, n, value);
+            keep(a);
+        });
+        harness.run("resize", "safe_resize_keeporder(+8,-8)", type, n, n, 4*E, [&]() {
+            a.safe_resize_keeporder(n + 8, n + 8, value);
+            a.safe_resize_keeporder(n, n, value);
+            keep(a);
+        });
+    }
+
+    /* ----- crop / pad / blit ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        harness.run("rect", "crop(-1)+pad(+1)", type, n, n, 4*E, [&]() {
+            a.crop(1, 1, n - 1, n - 1);
+            a.pad(1, 1, 1, 1, value);
+            keep(a);
+        });
+        harness.run("rect", "blit(self,+1,+1)", type, n, n, 2*E, [&]() {
+            a.blit(a, 0, 0, n - 1, n - 1, 1, 1);
+            keep(a);
+        });
+        const Array2D<T> src = make_grid<T>(n / 2, n / 2);
+        harness.run("rect", "blit(n/2 x n/2)", type, n, n, E / 2, [&]() {
+            a.blit(src, n / 4, n / 4);
+            keep(a);
+        });
+    }
+
+    /* ----- iterators and element access ----- */
+    {
+        const Array2D<T> a = make_grid<T>(n, n);
+        harness.run("iterate", "EntireIterator", type, n, n, E, [&]() {
+            size_t count = 0;
+            for (auto iter = a.cbegin(); iter != a.cend(); ++iter) {
+                keep(*iter);
+                ++count;
+            }
+            keep(count);
+        });
+        harness.run("iterate", "ColumnIterator", type, n, n, E, [&]() {
+            size_t count = 0;
+            for (size_t j=0; j < n; ++j) {
+                for (auto iter = a.cbegin_col(j); iter != a.cend_col(j); ++iter) {
+                    keep(*iter);
+                    ++count;
+                }
+            }
+            keep(count);
+        });
+        harness.run("iterate", "operator[][]", type, n, n, E, [&]() {
+            for (size_t i=0; i < n; ++i) {
+                const auto row = a[i];
+                for (size_t j=0; j < n; ++j) {
+                    keep(row[j]);
+                }
+            }
+        });
+    }
+
+    /* ----- map / fold ----- */
+    {
+        Array2D<T> a = make_grid<T>(n, n);
+        harness.run("map/fold", "map", type, n, n, 2*E, [&]() {
+            Array2D<T> b = a.template map<T>([](T x) { return x; });
+            keep(b);
+        });
+        Array2D<T> mapped;
+        harness.run("map/fold", "map_into", type, n, n, 2*E, [&]() {
+            a.template map_into<T>(mapped, [](T x) { return x; });
+            keep(mapped);
+        });
+        harness.run("map/fold", "map_inplace", type, n, n, 2*E, [&]() {
+            a.map_inplace([](T x) { return x; });
+            keep(a);
+        });
+        harness.run("map/fold", "foldl", type, n, n, E, [&]() {
+            size_t total = a.template foldl<size_t>([](size_t acc, T) { return acc + 1; }, 0);
+            keep(total);
+        });
+        if constexpr (arithmetic) {
+            harness.run("map/fold", "sum", type, n, n, E, [&]() {
+                T total = a.sum();
+                keep(total);
+            });
+            harness.run("map/fold", "sum_col(all)", type, n, n, E, [&]() {
+                for (size_t j=0; j < n; ++j) {
+                    T total = a.sum_col(j);
+                    keep(total);
+                }
+            });
+        }
+    }
+
+    /* ----- operators ----- */
+    {
+        const Array2D<T> a = make_grid<T>(n, n);
+        const Array2D<T> b = make_grid<T>(n, n);
+        harness.run("operators", "array+array", type, n, n, 3*E, [&]() {
+            Array2D<T> c = a + b;
+            keep(c);
+        });
+        Array2D<T> sum;
+        harness.run("operators", "add_into", type, n, n, 3*E, [&]() {
+            a.add_into(sum, b);
+            keep(sum);
+        });
+        harness.run("operators", "+= array", type, n, n, 3*E, [&]() {
+            sum += b;
+            keep(sum);
+        });
+        harness.run("operators", "array+scalar", type, n, n, 2*E, [&]() {
+            Array2D<T> c = a + value;
+            keep(c);
+        });
+        const Array2D<T> row_vec = make_grid<T>(1, n);
+        harness.run("operators", "array+row(broadcast)", type, n, n, 2*E, [&]() {
+            a.add_into(sum, row_vec);
+            keep(sum);
+        });
+        if constexpr (arithmetic) {
+            harness.run("operators", "array*array", type, n, n, 3*E, [&]() {
+                Array2D<T> c = a * b;
+                keep(c);
+            });
+            harness.run("operators", "-array", type, n, n, 2*E, [&]() {
+                Array2D<T> c = -a;
+                keep(c);
+            });
+        }
+    }
+
+    /* ----- pattern search ----- */
+    {
+        const Array2D<T> a = make_grid<T>(n, n);
+        // the 16x16 block at the bottom-right corner, so that there is at least one match
+        const size_t side = std::min<size_t>(n, 16);
+        std::vector<std::vector<T>> block(side);
+        for (size_t i=0; i < side; ++i) {
+            for (size_t j=0; j < side; ++j) {
+                block[i].push_back(a[n - side + i][n - side + j]);
+            }
+        }
+        const Array2D<T> pattern(std::move(block));
+        harness.run("search", "find_all(16x16)", type, n, n, E, [&]() {
+            std::vector<std::pair<size_t, size_t>> found = a.find_all(pattern);
+            keep(found);
+        });
+        harness.run("search", "find_first(16x16)", type, n, n, E, [&]() {
+            std::optional<std::pair<size_t, size_t>> found = a.find_first(pattern);
+            keep(found);
+        });
+    }
+
+    /* ----- to_string ----- */
+    {
+        const Array2D<T> a = make_grid<T>(n, n);
+        harness.run("to_string", "to_string", type, n, n, E, [&]() {
+            std::string text = a.to_string();
+            keep(text);
+        });
+    }
+}
+
+// Hand-written loops over plain buffers doing the same work as some Array2D cases, as a lower bound to compare against.
+template <class T>
+void bench_baselines(BenchHarness& harness, const std::string& type, const size_t n) {
+    const double E = static_cast<double>(n * n * sizeof(T));
+    std::vector<T> flat(n * n);
+    for (size_t k=0; k < flat.size(); ++k) {
+        flat[k] = make_value<T>(k);
+    }
+    const std::vector<std::vector<T>> nested = make_rows<T>(n, n);
+
+    harness.run("baseline", "flat_loop_walk", type, n, n, E, [&]() {
+        for (size_t k=0; k < n*n; ++k) {
+            keep(flat[k]);
+        }
+    });
+    harness.run("baseline", "flat_loop_column_walk", type, n, n, E, [&]() {
+        for (size_t j=0; j < n; ++j) {
+            for (size_t i=0; i < n; ++i) {
+                keep(flat[i*n + j]);
+            }
+        }
+    });
+    harness.run("baseline", "nested_vector_walk", type, n, n, E, [&]() {
+        for (const std::vector<T>& row : nested) {
+            for (const T& x : row) {
+                keep(x);
+            }
+        }
+    });
+    {
+        std::vector<T> out(n * n);
+        harness.run("baseline", "flat_loop_transpose", type, n, n, 2*E, [&]() {
+            for (size_t i=0; i < n; ++i) {
+                for (size_t j=0; j < n; ++j) {
+                    out[j*n + i] = flat[i*n + j];
+                }
+            }
+            keep(out);
+        });
+        harness.run("baseline", "flat_loop_map", type, n, n, 2*E, [&]() {
+            for (size_t k=0; k < n*n; ++k) {
+                out[k] = flat[k];
+            }
+            keep(out);
+        });
+    }
+    if constexpr (std::is_arithmetic<T>::value) {
+        harness.run("baseline", "flat_loop_sum", type, n, n, E, [&]() {
+            T total = T();
+            for (size_t k=0; k < n*n; ++k) {
+                total = total + flat[k];
+            }
+            keep(total);
+        });
+    }
+#if defined(__cpp_lib_mdspan)
+    {
+        const std::mdspan<const T, std::dextents<size_t, 2>> view(flat.data(), n, n);
+        harness.run("baseline", "mdspan_walk", type, n, n, E, [&]() {
+            for (size_t i=0; i < view.extent(0); ++i) {
+                for (size_t j=0; j < view.extent(1); ++j) {
+                    keep(view[i, j]);
+                }
+            }
+        });
+        harness.run("baseline", "mdspan_column_walk", type, n, n, E, [&]() {
+            for (size_t j=0; j < view.extent(1); ++j) {
+                for (size_t i=0; i < view.extent(0); ++i) {
+                    keep(view[i, j]);
+                }
+            }
+        });
+    }
+#endif
+}
+
+template <class T>
+void bench_type(BenchHarness& harness, const std::string& type, const std::vector<size_t>& sides) {
+    for (const size_t n : sides) {
+        bench_array2d<T>(harness, type, n);
+        bench_baselines<T>(harness, type, n);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t max_side = 1024;
+    std::string types = "char,int,double,string";
+    std::string json_path;
+    bool use_counters = true;
+    BenchHarness harness;
+    harness.set_min_time(100);
+
+    for (int k=1; k < argc; ++k) {
+        const std::string arg = argv[k];
+        const bool has_value = (k+1 < argc);
+        if (arg == "--max-side" && has_value) {
+            max_side = std::strtoull(argv[++k], nullptr, 10);
+        } else if (arg == "--min-time" && has_value) {
+            harness.set_min_time(std::atof(argv[++k]));
+        } else if (arg == "--types" && has_value) {
+            types = argv[++k];
+        } else if (arg == "--filter" && has_value) {
+            harness.set_filter(argv[++k]);
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++k];
+        } else if (arg == "--quiet") {
+            harness.set_quiet(true);
+        } else if (arg == "--no-counters") {
+            use_counters = false;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option '%s'!\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<size_t> sides;
+    for (size_t n=16; n <= 16384 && n <= max_side; n *= 4) {
+        sides.push_back(n);
+    }
+    if (use_counters && !harness.set_counters(true)) {
+        fprintf(stderr, "Note: hardware performance counters are unavailable here (see perf_event_paranoid, or the container's permissions), so only timings are reported.\n");
+    }
+#if !defined(__cpp_lib_mdspan)
+    fprintf(stderr, "Note: <mdspan> is not available, so the mdspan baselines are skipped.\n");
+#endif
+
+    const std::string list = "," + types + ",";
+    if (list.find(",char,") != std::string::npos)   { bench_type<char>(harness, "char", sides); }
+    if (list.find(",int,") != std::string::npos)    { bench_type<int>(harness, "int", sides); }
+    if (list.find(",double,") != std::string::npos) { bench_type<double>(harness, "double", sides); }
+    if (list.find(",string,") != std::string::npos) { bench_type<std::string>(harness, "std::string", sides); }
+
+    if (!json_path.empty()) {
+        FILE* out = fopen(json_path.c_str(), "w");
+        if (out == nullptr) {
+            fprintf(stderr, "Could not open '%s' for writing!\n", json_path.c_str());
+            return 1;
+        }
+        harness.write_json(out);
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,394 @@
+#ifndef YELLE_ARRAY2D_BENCH
+#define YELLE_ARRAY2D_BENCH
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace yelle {
+namespace bench {
+
+/* ============================
+    Allocation Counting
+============================= */
+// Running totals of heap allocations. They only move if the benchmark program replaces the global `operator new` and calls `count_allocation` from it, as `array2d_bench.cpp` does.
+inline std::atomic<size_t> allocation_count{0};
+inline std::atomic<size_t> allocation_bytes{0};
+
+inline void count_allocation(const size_t bytes) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// Keeps the compiler from optimizing away a result that's otherwise unused.
+template <class X>
+inline void keep(const X& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const volatile void* sink;
+    sink = &value;
+#endif
+}
+
+/* ============================
+    Hardware Counters
+============================= */
+// The hardware events that `PerfCounters` tries to count.
+enum counter_kind { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, DTLB_MISSES, BRANCH_MISSES, COUNTER_KINDS };
+
+inline const char* counter_name(const size_t kind) {
+    static const char* const names[COUNTER_KINDS] = {"cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+    return names[kind];
+}
+
+// Hardware performance counters for the calling thread, read through Linux's `perf_event_open`.
+// Each event is opened on its own, so that a CPU or VM lacking one event still counts the others. Events that can't be opened at all (no PMU, a container without `CAP_PERFMON`, `perf_event_paranoid` too high, or not Linux) are simply reported as unavailable.
+// Where the kernel multiplexes events, counts are scaled up by the fraction of time each one was actually running.
+class PerfCounters {
+protected:
+    std::array<int, COUNTER_KINDS> fds;
+
+#ifdef __linux__
+    static int open_event(const uint32_t type, const uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t cache_miss(const uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+public:
+    PerfCounters() {
+        fds.fill(-1);
+#ifdef __linux__
+        fds[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+        fds[LLC_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+        fds[DTLB_MISSES] = open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+        fds[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        return;
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    // Whether event `kind` could be opened.
+    bool available(const size_t kind) const {
+        return fds[kind] >= 0;
+    }
+
+    // Whether any event at all could be opened.
+    bool any_available() const {
+        for (const int fd : fds) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Zeroes and starts every available counter.
+    void start() {
+#ifdef __linux__
+        for (const int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Stops every counter, and returns the counts since `start()`; unavailable events read as `-1`.
+    std::array<double, COUNTER_KINDS> stop() {
+        std::array<double, COUNTER_KINDS> counts;
+        counts.fill(-1);
+#ifdef __linux__
+        for (const int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (size_t k=0; k < COUNTER_KINDS; ++k) {
+            uint64_t values[3];   // value, time enabled, time running
+            if (fds[k] < 0 || read(fds[k], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+                continue;
+            }
+            if (values[2] == 0) {
+                counts[k] = (values[1] == 0 ? 0 : -1);
+            } else {
+                counts[k] = static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+            }
+        }
+#endif
+        return counts;
+    }
+};
+
+/* ============================
+    Results
+============================= */
+// One timed benchmark case: one operation on one element type at one size.
+struct BenchResult {
+    std::string family;     // e.g. "transpose", "map/fold"
+    std::string name;       // e.g. "rotateCW"
+    std::string type;       // element type, e.g. "double"
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t iterations = 0;
+    double ns_per_iter = 0;
+    double ns_per_elem = 0;
+    double gb_per_s = 0;            // from the bytes that the operation is expected to read and write
+    double allocs_per_iter = 0;
+    double alloc_bytes_per_iter = 0;
+    std::array<double, COUNTER_KINDS> counters_per_elem;   // hardware events per element, or `-1` where unavailable
+
+    BenchResult() {
+        counters_per_elem.fill(-1);
+    }
+};
+
+// Escapes `text` for use inside a JSON string.
+inline std::string json_escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (const char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+/* ============================
+    Harness
+============================= */
+// Times benchmark cases and collects their results.
+// Each case is run once to warm up, then in batches of doubling size until `min_time_ms` has elapsed, and the fastest batch (per iteration) is reported, along with its allocations and (if turned on) hardware counter readings.
+class BenchHarness {
+protected:
+    std::vector<BenchResult> results;
+    double min_time_ms = 200;
+    std::string filter;
+    bool quiet = false;
+    PerfCounters* counters = nullptr;   // only created if counters are turned on
+
+public:
+    BenchHarness() {
+        return;
+    }
+
+    BenchHarness(const BenchHarness&) = delete;
+    BenchHarness& operator=(const BenchHarness&) = delete;
+
+    ~BenchHarness() {
+        delete counters;
+    }
+
+    // Turns hardware performance counters on or off (they're off by default). Returns whether any counter could actually be opened; if not, results simply leave them out.
+    bool set_counters(const bool enabled) {
+        delete counters;
+        counters = nullptr;
+        if (enabled) {
+            counters = new PerfCounters();
+            if (!counters->any_available()) {
+                delete counters;
+                counters = nullptr;
+            }
+        }
+        return counters != nullptr;
+    }
+
+    // Sets the minimum total time spent timing each case.
+    BenchHarness& set_min_time(const double milliseconds) {
+        min_time_ms = milliseconds;
+        return *this;
+    }
+
+    // Only cases whose `family/name` contains `text` will be run.
+    BenchHarness& set_filter(const std::string& text) {
+        filter = text;
+        return *this;
+    }
+
+    // Turns the per-case line on `stdout` off or on.
+    BenchHarness& set_quiet(const bool no_output) {
+        quiet = no_output;
+        return *this;
+    }
+
+    // Whether the case `family/name` passes the filter.
+    bool wanted(const std::string& family, const std::string& name) const {
+        return filter.empty() || (family + "/" + name).find(filter) != std::string::npos;
+    }
+
+    // Times `body()`, which should perform the operation once on a `rows` x `cols` array and leave the array as it found it (or in an equally costly state).
+    // `bytes_per_iter` is how many bytes of element data the operation should read plus write, which gives the GB/s figure.
+    template <class Body>
+    BenchHarness& run(const std::string& family, const std::string& name, const std::string& type,
+                      const size_t rows, const size_t cols, const double bytes_per_iter, Body body) {
+        if (!wanted(family, name)) {
+            return *this;
+        }
+        using clock = std::chrono::steady_clock;
+        body();
+
+        double best_ns = -1;
+        std::array<double, COUNTER_KINDS> best_counts;
+        best_counts.fill(-1);
+        size_t best_allocs = 0;
+        size_t best_alloc_bytes = 0;
+        size_t total_iters = 0;
+        double spent_ms = 0;
+        for (size_t batch=1; spent_ms < min_time_ms; batch *= 2) {
+            const size_t allocs_before = allocation_count.load(std::memory_order_relaxed);
+            const size_t bytes_before = allocation_bytes.load(std::memory_order_relaxed);
+            if (counters != nullptr) {
+                counters->start();
+            }
+            const auto start = clock::now();
+            for (size_t b=0; b < batch; ++b) {
+                body();
+            }
+            const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            std::array<double, COUNTER_KINDS> counts;
+            counts.fill(-1);
+            if (counters != nullptr) {
+                counts = counters->stop();
+            }
+            const size_t allocs = allocation_count.load(std::memory_order_relaxed) - allocs_before;
+            const size_t alloc_bytes = allocation_bytes.load(std::memory_order_relaxed) - bytes_before;
+            if (best_ns < 0 || ns / batch < best_ns) {
+                best_ns = ns / batch;
+                best_allocs = allocs / batch;
+                best_alloc_bytes = alloc_bytes / batch;
+                for (size_t c=0; c < COUNTER_KINDS; ++c) {
+                    best_counts[c] = (counts[c] < 0 ? -1 : counts[c] / batch);
+                }
+            }
+            total_iters += batch;
+            spent_ms += ns / 1e6;
+        }
+
+        BenchResult result;
+        result.family = family;
+        result.name = name;
+        result.type = type;
+        result.rows = rows;
+        result.cols = cols;
+        result.iterations = total_iters;
+        result.ns_per_iter = best_ns;
+        result.ns_per_elem = (rows * cols == 0 ? 0 : best_ns / static_cast<double>(rows * cols));
+        result.gb_per_s = (best_ns <= 0 ? 0 : bytes_per_iter / best_ns);
+        result.allocs_per_iter = static_cast<double>(best_allocs);
+        result.alloc_bytes_per_iter = static_cast<double>(best_alloc_bytes);
+        for (size_t c=0; c < COUNTER_KINDS; ++c) {
+            if (best_counts[c] >= 0 && rows * cols != 0) {
+                result.counters_per_elem[c] = best_counts[c] / static_cast<double>(rows * cols);
+            }
+        }
+        if (!quiet) {
+            fprintf(stdout, "%-14s %-26s %-11s %6zux%-6zu %10.3f ns/elem %8.3f GB/s %10.1f allocs",
+                family.c_str(), name.c_str(), type.c_str(), rows, cols, result.ns_per_elem, result.gb_per_s, result.allocs_per_iter);
+            const std::array<double, COUNTER_KINDS>& per = result.counters_per_elem;
+            if (per[CYCLES] > 0 && per[INSTRUCTIONS] >= 0) {
+                fprintf(stdout, " %6.2f IPC", per[INSTRUCTIONS] / per[CYCLES]);
+            }
+            if (per[L1D_MISSES] >= 0) {
+                fprintf(stdout, " %7.3f L1D/elem", per[L1D_MISSES]);
+            }
+            if (per[LLC_MISSES] >= 0) {
+                fprintf(stdout, " %7.3f LLC/elem", per[LLC_MISSES]);
+            }
+            if (per[DTLB_MISSES] >= 0) {
+                fprintf(stdout, " %7.4f dTLB/elem", per[DTLB_MISSES]);
+            }
+            if (per[BRANCH_MISSES] >= 0) {
+                fprintf(stdout, " %7.4f branch/elem", per[BRANCH_MISSES]);
+            }
+            fprintf(stdout, "\n");
+            fflush(stdout);
+        }
+        results.push_back(result);
+        return *this;
+    }
+
+    const std::vector<BenchResult>& get_results() const {
+        return results;
+    }
+
+    // Writes all results collected so far to `out` as a JSON array of objects, one per case.
+    void write_json(FILE* out) const {
+        fprintf(out, "[\n");
+        for (size_t k=0; k < results.size(); ++k) {
+            const BenchResult& r = results[k];
+            fprintf(out, "  {\"family\": \"%s\", \"name\": \"%s\", \"type\": \"%s\", \"rows\": %zu, \"cols\": %zu, "
+                         "\"iterations\": %zu, \"ns_per_iter\": %.3f, \"ns_per_elem\": %.6f, \"gb_per_s\": %.6f, "
+                         "\"allocs_per_iter\": %.1f, \"alloc_bytes_per_iter\": %.1f",
+                json_escape(r.family).c_str(), json_escape(r.name).c_str(), json_escape(r.type).c_str(), r.rows, r.cols,
+                r.iterations, r.ns_per_iter, r.ns_per_elem, r.gb_per_s,
+                r.allocs_per_iter, r.alloc_bytes_per_iter);
+            // unavailable counters are left out, rather than written as a made-up value
+            for (size_t c=0; c < COUNTER_KINDS; ++c) {
+                if (r.counters_per_elem[c] >= 0) {
+                    fprintf(out, ", \"%s_per_elem\": %.6f", counter_name(c), r.counters_per_elem[c]);
+                }
+            }
+            fprintf(out, "}%s\n", (k+1 < results.size() ? "," : ""));
+        }
+        fprintf(out, "]\n");
+    }
+};
+
+};  // end namespace bench
+};  // end namespace yelle
+#endif
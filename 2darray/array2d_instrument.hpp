@@ -0,0 +1,261 @@
+#ifndef YELLE_ARRAY2D_INSTRUMENT_HPP
+#define YELLE_ARRAY2D_INSTRUMENT_HPP
+
+// Counters and timers behind `Array2D`'s optional instrumentation. Nothing here is used unless `YELLE_ARRAY2D_INSTRUMENT` is defined before `array2d.cpp` is included.
+// Each instrumented method keeps, across all element types:
+//   * calls, and cumulative (inclusive) wall-clock time
+//   * heap allocations and bytes made while it was the innermost instrumented method on its thread (only if the program defines `YELLE_ARRAY2D_INSTRUMENT_NEW` in exactly one file before including, which replaces the global `operator new`)
+//   * elements copied and moved by it (and the private helpers it calls), as counted by the methods themselves; swaps count as three moves
+// Counters are relaxed atomics, so any thread may update or read them; call sites look their counters up once (in a function-local static), so the per-call cost is two clock reads and a handful of atomic adds.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace yelle {
+namespace instrument {
+
+// Live counters of one instrumented method.
+struct OpStats {
+    std::string name;
+    std::atomic<size_t> calls{0};
+    std::atomic<size_t> nanoseconds{0};
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> allocated_bytes{0};
+    std::atomic<size_t> element_copies{0};
+    std::atomic<size_t> element_moves{0};
+
+    explicit OpStats(const std::string& op_name) : name(op_name) {
+        return;
+    }
+};
+
+// Plain copy of one method's counters at some moment.
+struct OpSnapshot {
+    std::string name;
+    size_t calls = 0;
+    size_t nanoseconds = 0;
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+    size_t element_copies = 0;
+    size_t element_moves = 0;
+};
+
+// One finished call, as recorded while tracing is on.
+struct TraceEvent {
+    const OpStats* op;
+    size_t thread;
+    long long start_ns;
+    long long duration_ns;
+};
+
+// Everything shared between threads: the registered methods (in a `deque`, so that their addresses never change) and the trace buffer.
+struct Registry {
+    std::mutex lock;
+    std::deque<OpStats> ops;
+    std::atomic<bool> tracing{false};
+    size_t trace_limit = 0;
+    std::vector<TraceEvent> trace;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+inline Registry& registry() {
+    static Registry reg;
+    return reg;
+}
+
+// Returns the counters for the method called `name`, registering it on first use.
+inline OpStats& op_stats(const char* name) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (OpStats& op : reg.ops) {
+        if (op.name == name) {
+            return op;
+        }
+    }
+    reg.ops.emplace_back(name);
+    return reg.ops.back();
+}
+
+// Innermost instrumented method running on this thread, to which allocations are attributed.
+inline OpStats*& current_op() {
+    thread_local OpStats* current = nullptr;
+    return current;
+}
+
+// Small sequential id for this thread, for trace output.
+inline size_t thread_number() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t mine = next.fetch_add(1, std::memory_order_relaxed);
+    return mine;
+}
+
+// Called by the replacement `operator new`.
+inline void on_allocation(const size_t bytes) noexcept {
+    OpStats* op = current_op();
+    if (op != nullptr) {
+        op->allocations.fetch_add(1, std::memory_order_relaxed);
+        op->allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+// Records that the innermost instrumented method on this thread copied `copies` elements and moved `moves` of them.
+inline void count_elements(const size_t copies, const size_t moves) noexcept {
+    OpStats* op = current_op();
+    if (op == nullptr) {
+        return;
+    }
+    if (copies != 0) {
+        op->element_copies.fetch_add(copies, std::memory_order_relaxed);
+    }
+    if (moves != 0) {
+        op->element_moves.fetch_add(moves, std::memory_order_relaxed);
+    }
+}
+
+// Counts and times one call of an instrumented method for as long as it is alive.
+class ScopedOp {
+protected:
+    OpStats& op;
+    OpStats* outer;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedOp(OpStats& stats) : op(stats), outer(current_op()), start(std::chrono::steady_clock::now()) {
+        current_op() = &op;
+        return;
+    }
+
+    ScopedOp(const ScopedOp&) = delete;
+    ScopedOp& operator=(const ScopedOp&) = delete;
+
+    ~ScopedOp() {
+        const auto finish = std::chrono::steady_clock::now();
+        const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+        op.calls.fetch_add(1, std::memory_order_relaxed);
+        op.nanoseconds.fetch_add(static_cast<size_t>(ns), std::memory_order_relaxed);
+        current_op() = outer;
+
+        Registry& reg = registry();
+        if (reg.tracing.load(std::memory_order_relaxed)) {
+            const long long since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(start - reg.epoch).count();
+            std::lock_guard<std::mutex> guard(reg.lock);
+            if (reg.trace.size() < reg.trace_limit) {
+                reg.trace.push_back(TraceEvent{&op, thread_number(), since_epoch, ns});
+            }
+        }
+    }
+};
+
+/* ============================
+    Control & Export
+============================= */
+// Starts recording every instrumented call (up to `max_events` of them) for `write_chrome_trace`, discarding any previous trace.
+inline void start_trace(const size_t max_events = 1000000) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.trace.clear();
+    reg.trace_limit = max_events;
+    reg.tracing.store(true, std::memory_order_relaxed);
+}
+
+// Stops recording calls; what was recorded is kept until the next `start_trace`.
+inline void stop_trace() {
+    registry().tracing.store(false, std::memory_order_relaxed);
+}
+
+// Returns a copy of every method's counters.
+inline std::vector<OpSnapshot> snapshot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    std::vector<OpSnapshot> out;
+    out.reserve(reg.ops.size());
+    for (const OpStats& op : reg.ops) {
+        OpSnapshot snap;
+        snap.name = op.name;
+        snap.calls = op.calls.load(std::memory_order_relaxed);
+        snap.nanoseconds = op.nanoseconds.load(std::memory_order_relaxed);
+        snap.allocations = op.allocations.load(std::memory_order_relaxed);
+        snap.allocated_bytes = op.allocated_bytes.load(std::memory_order_relaxed);
+        snap.element_copies = op.element_copies.load(std::memory_order_relaxed);
+        snap.element_moves = op.element_moves.load(std::memory_order_relaxed);
+        out.push_back(snap);
+    }
+    return out;
+}
+
+// Zeroes every method's counters (the methods stay registered).
+inline void reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (OpStats& op : reg.ops) {
+        op.calls.store(0, std::memory_order_relaxed);
+        op.nanoseconds.store(0, std::memory_order_relaxed);
+        op.allocations.store(0, std::memory_order_relaxed);
+        op.allocated_bytes.store(0, std::memory_order_relaxed);
+        op.element_copies.store(0, std::memory_order_relaxed);
+        op.element_moves.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Writes `snapshot()` to `out` as a JSON array, skipping methods that were never called.
+inline void write_snapshot_json(FILE* out) {
+    const std::vector<OpSnapshot> snaps = snapshot();
+    fprintf(out, "[\n");
+    bool first = true;
+    for (const OpSnapshot& s : snaps) {
+        if (s.calls == 0) {
+            continue;
+        }
+        fprintf(out, "%s  {\"op\": \"%s\", \"calls\": %zu, \"ns\": %zu, \"allocations\": %zu, \"allocated_bytes\": %zu, \"element_copies\": %zu, \"element_moves\": %zu}",
+            (first ? "" : ",\n"), s.name.c_str(), s.calls, s.nanoseconds, s.allocations, s.allocated_bytes, s.element_copies, s.element_moves);
+        first = false;
+    }
+    fprintf(out, "\n]\n");
+}
+
+// Writes the calls recorded since `start_trace` to `out` in the Chrome trace-event format, for loading into `chrome://tracing` or Perfetto.
+inline void write_chrome_trace(FILE* out) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    fprintf(out, "{\"traceEvents\": [\n");
+    for (size_t k=0; k < reg.trace.size(); ++k) {
+        const TraceEvent& e = reg.trace[k];
+        // timestamps are in microseconds
+        fprintf(out, "  {\"name\": \"%s\", \"cat\": \"Array2D\", \"ph\": \"X\", \"pid\": 1, \"tid\": %zu, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+            e.op->name.c_str(), e.thread, e.start_ns / 1000.0, e.duration_ns / 1000.0, (k+1 < reg.trace.size() ? "," : ""));
+    }
+    fprintf(out, "], \"displayTimeUnit\": \"ns\"}\n");
+}
+
+};  // end namespace instrument
+};  // end namespace yelle
+
+// Replacement global allocation functions that attribute allocations to the running Array2D method. Define `YELLE_ARRAY2D_INSTRUMENT_NEW` in exactly one source file.
+// (GCC can't tell that these replace the global operators, and would warn about `free`ing what `operator new` returned.)
+#ifdef YELLE_ARRAY2D_INSTRUMENT_NEW
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t bytes) {
+    yelle::instrument::on_allocation(bytes);
+    if (void* ptr = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+#endif
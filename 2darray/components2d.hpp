@@ -0,0 +1,274 @@
+#ifndef YELLE_COMPONENTS2D
+#define YELLE_COMPONENTS2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+
+namespace yelle {
+
+// Size and bounding box of one connected component.
+struct ComponentInfo {
+    size_t size = 0;
+    // bounding box, as the half-open ranges `[i_start, i_past_end) x [j_start, j_past_end)`
+    size_t i_start = SIZE_MAX;
+    size_t j_start = SIZE_MAX;
+    size_t i_past_end = 0;
+    size_t j_past_end = 0;
+
+    void add(const size_t i, const size_t j) {
+        ++size;
+        i_start = std::min(i_start, i);
+        j_start = std::min(j_start, j);
+        i_past_end = std::max(i_past_end, i+1);
+        j_past_end = std::max(j_past_end, j+1);
+    }
+
+    void merge(const ComponentInfo& other) {
+        size += other.size;
+        i_start = std::min(i_start, other.i_start);
+        j_start = std::min(j_start, other.j_start);
+        i_past_end = std::max(i_past_end, other.i_past_end);
+        j_past_end = std::max(j_past_end, other.j_past_end);
+    }
+};
+
+// Result of `label_components` or `label_regions`.
+struct ComponentLabels {
+    // Label of each cell: `0` for cells outside every component, otherwise `1` through `components.size()`, numbered in the order that the components are first met in a row-major scan.
+    Array2D<uint32_t> labels;
+    // `components[k-1]` describes the component labelled `k`.
+    std::vector<ComponentInfo> components;
+};
+
+namespace components_detail {
+
+// Union-find over the cells of the grid, stored in one flat array: `parent[k]` is `0` for a cell outside every component, and otherwise `p+1` for the cell's parent `p`, where a root is its own parent.
+// Every link points to a smaller index, so the root of each component is its first cell in row-major order.
+// Once the components are numbered, each root's entry is replaced by its final label tagged with `LABELLED`.
+constexpr uint32_t LABELLED = 0x80000000u;
+
+// Returns the root of cell `k`, halving the path to it on the way.
+inline uint32_t find_root(std::vector<uint32_t>& parent, uint32_t k) {
+    while (parent[k] - 1 != k) {
+        parent[k] = parent[parent[k] - 1];
+        k = parent[k] - 1;
+    }
+    return k;
+}
+
+// Joins the sets of cells `a` and `b`, returning the root that was linked under the other (or `UINT32_MAX` if they were already joined).
+inline uint32_t unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a == b) {
+        return UINT32_MAX;
+    }
+    if (a < b) {
+        std::swap(a, b);
+    }
+    parent[a] = b + 1;
+    return a;
+}
+
+// Calls `func(strip, r0, r1)` for each of `strips` horizontal strips of `row_ct` rows, on a thread each (the first on the calling thread).
+template <class Func>
+void for_each_strip(const size_t row_ct, const size_t strips, const Func& func) {
+    const size_t strip_rows = (row_ct + strips - 1) / strips;
+    std::vector<std::thread> pool;
+    pool.reserve(strips - 1);
+    for (size_t s=1; s < strips; ++s) {
+        pool.emplace_back([&func, s, strip_rows, row_ct]() {
+            func(s, std::min(row_ct, s * strip_rows), std::min(row_ct, (s+1) * strip_rows));
+        });
+    }
+    func(0, 0, std::min(row_ct, strip_rows));
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
+
+// Labels the components of cells for which `included(cell)` holds, where neighbouring included cells `a` and `b` are in the same component if `same(a, b)`.
+template <class T, class Included, class Same>
+ComponentLabels label(const Array2D<T>& grid, const Included& included, const Same& same, const connectivity conn, size_t threads) {
+    ComponentLabels result;
+    const size_t row_ct = grid.rowCount();
+    const size_t col_ct = grid.colCount();
+    if (row_ct == 0 || col_ct == 0) {
+        return result;
+    }
+    if (row_ct * col_ct >= LABELLED - 1) {
+        fprintf(stderr, "Cannot label the components of a %zu x %zu array: it has too many cells for 32-bit labels!\n", row_ct, col_ct);
+        throw std::length_error("array too large to label");
+    }
+    const bool diagonals = (conn == connectivity::EIGHT);
+    // don't bother spinning up threads for grids that are too small to benefit
+    const size_t min_rows_per_thread = 64;
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    const size_t strips = std::max<size_t>(1, std::min(threads, row_ct / min_rows_per_thread));
+    const size_t strip_rows = (row_ct + strips - 1) / strips;
+
+    std::vector<uint32_t> parent(row_ct * col_ct);
+    std::vector<std::vector<uint32_t>> out(row_ct);
+
+    // Pass 1, each strip on its own: join each included cell with its already-scanned neighbours inside the strip, then point every cell straight at its root within the strip.
+    for_each_strip(row_ct, strips, [&](const size_t, const size_t r0, const size_t r1) {
+        for (size_t i=r0; i < r1; ++i) {
+            const auto row = grid[i];
+            const auto above = grid[i > r0 ? i-1 : i];
+            const size_t base = i * col_ct;
+            for (size_t j=0; j < col_ct; ++j) {
+                const uint32_t k = static_cast<uint32_t>(base + j);
+                if (!included(row[j])) {
+                    parent[k] = 0;
+                    continue;
+                }
+                parent[k] = k + 1;
+                if (j > 0 && parent[k-1] != 0 && same(row[j], row[j-1])) {
+                    unite(parent, k, k-1);
+                }
+                if (i > r0) {
+                    const uint32_t up = static_cast<uint32_t>(k - col_ct);
+                    if (parent[up] != 0 && same(row[j], above[j])) {
+                        unite(parent, k, up);
+                    }
+                    if (diagonals) {
+                        if (j > 0 && parent[up-1] != 0 && same(row[j], above[j-1])) {
+                            unite(parent, k, up-1);
+                        }
+                        if (j+1 < col_ct && parent[up+1] != 0 && same(row[j], above[j+1])) {
+                            unite(parent, k, up+1);
+                        }
+                    }
+                }
+            }
+        }
+        // parents always come earlier in the scan, so one pass in scan order flattens every path
+        for (size_t k=r0 * col_ct; k < r1 * col_ct; ++k) {
+            if (parent[k] != 0 && parent[k] - 1 != k) {
+                parent[k] = parent[parent[k] - 1];
+            }
+        }
+        for (size_t i=r0; i < r1; ++i) {
+            out[i].assign(col_ct, 0);
+        }
+    });
+
+    // Merge, on this thread: join the components that meet across each boundary between strips, then point each strip's root that was linked straight at its global root.
+    std::vector<uint32_t> linked;
+    for (size_t r0=strip_rows; r0 < row_ct; r0 += strip_rows) {
+        const auto row = grid[r0];
+        const auto above = grid[r0-1];
+        for (size_t j=0; j < col_ct; ++j) {
+            const uint32_t k = static_cast<uint32_t>(r0 * col_ct + j);
+            if (parent[k] == 0) {
+                continue;
+            }
+            const uint32_t up = static_cast<uint32_t>(k - col_ct);
+            const auto join = [&](const uint32_t other, const T& other_value) {
+                if (parent[other] != 0 && same(row[j], other_value)) {
+                    const uint32_t moved = unite(parent, k, other);
+                    if (moved != UINT32_MAX) {
+                        linked.push_back(moved);
+                    }
+                }
+            };
+            join(up, above[j]);
+            if (diagonals) {
+                if (j > 0) {
+                    join(up-1, above[j-1]);
+                }
+                if (j+1 < col_ct) {
+                    join(up+1, above[j+1]);
+                }
+            }
+        }
+    }
+    for (const uint32_t k : linked) {
+        parent[k] = find_root(parent, k) + 1;
+    }
+    // Every included cell now reaches its global root in at most two hops.
+
+    // Pass 2, each strip on its own: find the global roots in the strip (in scan order), which are numbered consecutively across strips.
+    std::vector<std::vector<uint32_t>> roots(strips);
+    for_each_strip(row_ct, strips, [&](const size_t s, const size_t r0, const size_t r1) {
+        for (size_t k=r0 * col_ct; k < r1 * col_ct; ++k) {
+            if (parent[k] == k + 1) {
+                roots[s].push_back(static_cast<uint32_t>(k));
+            }
+        }
+    });
+    std::vector<uint32_t> first_label(strips + 1, 1);
+    for (size_t s=0; s < strips; ++s) {
+        first_label[s+1] = first_label[s] + static_cast<uint32_t>(roots[s].size());
+    }
+    for_each_strip(row_ct, strips, [&](const size_t s, const size_t, const size_t) {
+        uint32_t next = first_label[s];
+        for (const uint32_t k : roots[s]) {
+            parent[k] = LABELLED | next++;
+        }
+    });
+
+    // Pass 3, each strip on its own: label every other cell after its root, and gather the components' sizes and bounding boxes.
+    // Components whose root is in the strip are gathered into a slice of the result directly; the few that reach down into it from strips above are gathered separately and merged afterwards.
+    result.components.resize(first_label[strips] - 1);
+    std::vector<std::unordered_map<uint32_t, ComponentInfo>> from_above(strips);
+    for_each_strip(row_ct, strips, [&](const size_t s, const size_t r0, const size_t r1) {
+        for (size_t i=r0; i < r1; ++i) {
+            std::vector<uint32_t>& out_row = out[i];
+            for (size_t j=0; j < col_ct; ++j) {
+                uint32_t link = parent[i * col_ct + j];
+                if (link == 0) {
+                    continue;
+                }
+                // at most three hops: to the strip's root, to the global root, and to its label
+                while ((link & LABELLED) == 0) {
+                    link = parent[link - 1];
+                }
+                const uint32_t label = link & ~LABELLED;
+                out_row[j] = label;
+                if (label >= first_label[s]) {
+                    result.components[label - 1].add(i, j);
+                } else {
+                    from_above[s][label].add(i, j);
+                }
+            }
+        }
+    });
+    for (const auto& strip_map : from_above) {
+        for (const auto& entry : strip_map) {
+            result.components[entry.first - 1].merge(entry.second);
+        }
+    }
+
+    result.labels = Array2D<uint32_t>(std::move(out));
+    return result;
+}
+
+};  // end namespace components_detail
+
+// Labels the connected components of the cells for which `pred(cell)` is `true`, treating the array as a 4- or 8-connected grid.
+// Returns an `Array2D<uint32_t>` of labels (`0` for cells where `pred` is `false`), and each component's size and bounding box.
+// Runs in two union-find passes over horizontal strips, on up to `threads` threads at once (`0` for the hardware's concurrency), without recursion, so there is no limit on the size of a component.
+// Throws a `std::length_error` if the array has `2^31 - 1` or more cells.
+template <class T, class Pred>
+ComponentLabels label_components(const Array2D<T>& grid, Pred pred, const connectivity conn = connectivity::FOUR, const size_t threads = 0) {
+    return components_detail::label(grid, pred, [](const T&, const T&) { return true; }, conn, threads);
+}
+
+// Labels the connected regions of equal cells: every cell is labelled, and neighbouring cells share a label exactly when they are equal (by `operator==`).
+// Otherwise the same as `label_components`.
+template <class T>
+ComponentLabels label_regions(const Array2D<T>& grid, const connectivity conn = connectivity::FOUR, const size_t threads = 0) {
+    return components_detail::label(grid, [](const T&) { return true; }, [](const T& a, const T& b) { return a == b; }, conn, threads);
+}
+
+};  // end namespace
+#endif
@@ -0,0 +1,401 @@
+#ifndef YELLE_CONCURRENT_ARRAY2D
+#define YELLE_CONCURRENT_ARRAY2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+namespace yelle {
+
+// A fixed-size 2D array that many threads can update at once.
+// The array is divided into `TILE` x `TILE` tiles, each guarded by one of a fixed pool of striped reader/writer locks (tile `t` uses lock `t % stripe_count()`), so that threads working on different parts of the array rarely contend.
+// There are two ways in:
+//   * `with_region` / `read_region` lock just the tiles that a rectangle overlaps, always in increasing lock order (so that no two calls can deadlock), and hand a view of the rectangle to a function
+//   * for arithmetic `T`, `fetch_add`, `compare_exchange`, `load`, and `store` update or read single cells atomically without taking any lock
+// A cell must not be accessed both ways at the same time: e.g. have accumulation workers use `fetch_add` for one phase, and read the results with `read_region` in the next.
+template <class T, size_t TILE = 64>
+class ConcurrentArray2D {
+    static_assert(TILE > 0, "tile side must be positive");
+protected:
+    // Each lock sits on its own cache line, so that threads taking neighbouring locks don't slow each other down.
+    struct alignas(64) Stripe {
+        std::shared_mutex lock;
+    };
+
+    // Row-major elements.
+    std::vector<T> data;
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+    size_t tiles_across = 0;
+    size_t stripe_ct = 0;
+    std::unique_ptr<Stripe[]> stripes;
+
+    void make_stripes(const size_t max_stripes) {
+        tiles_across = (col_ct + TILE - 1) / TILE;
+        const size_t tile_ct = ((row_ct + TILE - 1) / TILE) * tiles_across;
+        stripe_ct = std::max<size_t>(1, std::min(tile_ct, max_stripes));
+        stripes.reset(new Stripe[stripe_ct]);
+    }
+
+    // Throws a `std::out_of_range` unless `[i_start, i_past_end) x [j_start, j_past_end)` lies within the array.
+    void check_region(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) const {
+        if (i_start > i_past_end || j_start > j_past_end || i_past_end > row_ct || j_past_end > col_ct) {
+            fprintf(stderr, "Region [%zu,%zu) x [%zu,%zu) is not within a %zu x %zu array!\n", i_start, i_past_end, j_start, j_past_end, row_ct, col_ct);
+            throw std::out_of_range("region is not within the concurrent array");
+        }
+    }
+
+    // The lock guarding the tile that holds `(i,j)`.
+    size_t stripe_of(const size_t i, const size_t j) const {
+        return ((i / TILE) * tiles_across + (j / TILE)) % stripe_ct;
+    }
+
+    // A list of lock indices. The first `INLINE` are kept inside the object, so that locking a region of a few tiles doesn't allocate.
+    class StripeSet {
+        static constexpr size_t INLINE = 8;
+        size_t inline_ids[INLINE];
+        std::vector<size_t> spilled;    // all of the indices, once there are more than `INLINE`
+        size_t count = 0;
+
+    public:
+        void push_back(const size_t id) {
+            if (count < INLINE) {
+                inline_ids[count] = id;
+            } else {
+                if (spilled.empty()) {
+                    spilled.assign(inline_ids, inline_ids + INLINE);
+                }
+                spilled.push_back(id);
+            }
+            ++count;
+        }
+        // Sorts the indices and removes repeats.
+        void sort_unique() {
+            std::sort(begin(), end());
+            count = static_cast<size_t>(std::unique(begin(), end()) - begin());
+        }
+        size_t* begin() { return (spilled.empty() ? inline_ids : spilled.data()); }
+        size_t* end() { return begin() + count; }
+        const size_t* begin() const { return (spilled.empty() ? inline_ids : spilled.data()); }
+        const size_t* end() const { return begin() + count; }
+    };
+
+    // Returns the locks guarding the tiles that the region overlaps, in increasing order and without repeats.
+    StripeSet region_stripes(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) const {
+        StripeSet found;
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return found;
+        }
+        for (size_t ti=i_start / TILE; ti <= (i_past_end - 1) / TILE; ++ti) {
+            for (size_t tj=j_start / TILE; tj <= (j_past_end - 1) / TILE; ++tj) {
+                found.push_back((ti * tiles_across + tj) % stripe_ct);
+            }
+        }
+        found.sort_unique();
+        return found;
+    }
+
+    // Holds a set of locks (exclusively or shared) from construction until destruction, taking them in the order given.
+    template <bool SHARED>
+    class RegionLock {
+    protected:
+        Stripe* stripes;
+        StripeSet held;
+
+    public:
+        RegionLock(Stripe* all, StripeSet&& which) : stripes(all), held(std::move(which)) {
+            for (const size_t s : held) {
+                if constexpr (SHARED) {
+                    stripes[s].lock.lock_shared();
+                } else {
+                    stripes[s].lock.lock();
+                }
+            }
+            return;
+        }
+
+        RegionLock(const RegionLock&) = delete;
+        RegionLock& operator=(const RegionLock&) = delete;
+
+        ~RegionLock() {
+            for (const size_t* it = held.end(); it != held.begin(); ) {
+                --it;
+                if constexpr (SHARED) {
+                    stripes[*it].lock.unlock_shared();
+                } else {
+                    stripes[*it].lock.unlock();
+                }
+            }
+        }
+    };
+
+    // Atomic access to one cell, through `std::atomic_ref` where the standard library has it (C++20), and otherwise through the GCC/Clang builtins it is built on.
+#ifdef __cpp_lib_atomic_ref
+    static T cell_load(const T& cell, const std::memory_order order) {
+        return std::atomic_ref<T>(const_cast<T&>(cell)).load(order);
+    }
+    static void cell_store(T& cell, const T value, const std::memory_order order) {
+        std::atomic_ref<T>(cell).store(value, order);
+    }
+    static bool cell_compare_exchange(T& cell, T& expected, const T desired, const std::memory_order order) {
+        return std::atomic_ref<T>(cell).compare_exchange_strong(expected, desired, order);
+    }
+    static T cell_fetch_add(T& cell, const T delta, const std::memory_order order) {
+        return std::atomic_ref<T>(cell).fetch_add(delta, order);
+    }
+#else
+    static int builtin_order(const std::memory_order order) {
+        return static_cast<int>(order);
+    }
+    // the order of a failed compare-exchange can't include a release
+    static int builtin_failure_order(const std::memory_order order) {
+        return (order == std::memory_order_acq_rel ? __ATOMIC_ACQUIRE : order == std::memory_order_release ? __ATOMIC_RELAXED : builtin_order(order));
+    }
+    static T cell_load(const T& cell, const std::memory_order order) {
+        T value;
+        __atomic_load(&cell, &value, builtin_order(order));
+        return value;
+    }
+    static void cell_store(T& cell, T value, const std::memory_order order) {
+        __atomic_store(&cell, &value, builtin_order(order));
+    }
+    static bool cell_compare_exchange(T& cell, T& expected, T desired, const std::memory_order order) {
+        return __atomic_compare_exchange(&cell, &expected, &desired, false, builtin_order(order), builtin_failure_order(order));
+    }
+    static T cell_fetch_add(T& cell, const T delta, const std::memory_order order) {
+        if constexpr (std::is_integral<T>::value) {
+            return __atomic_fetch_add(&cell, delta, builtin_order(order));
+        } else {
+            // no native floating-point add, so retry until no other thread got in between
+            T old = cell_load(cell, std::memory_order_relaxed);
+            while (!cell_compare_exchange(cell, old, old + delta, order)) {
+            }
+            return old;
+        }
+    }
+#endif
+
+    // Throws a `std::out_of_range` if there is no element at `(i,j)`.
+    void check_cell(const size_t i, const size_t j) const {
+        if (i >= row_ct || j >= col_ct) {
+            throw std::out_of_range("tried to access nonexistent row or column of concurrent array");
+        }
+    }
+
+public:
+    // View of the locked rectangle handed to the function given to `with_region` or `read_region`, addressed by the array's own `(i,j)` coordinates.
+    class Region {
+    protected:
+        T* data;
+        size_t cols;
+        size_t i_lo, j_lo, i_hi, j_hi;
+
+    public:
+        Region(T* base, const size_t col_count, const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end)
+        : data(base), cols(col_count), i_lo(i_start), j_lo(j_start), i_hi(i_past_end), j_hi(j_past_end) {
+            return;
+        }
+
+        size_t i_start() const { return i_lo; }
+        size_t j_start() const { return j_lo; }
+        size_t i_past_end() const { return i_hi; }
+        size_t j_past_end() const { return j_hi; }
+
+        // Direct access to the element at `(i,j)`, which must be inside the region (unchecked).
+        T& operator()(const size_t i, const size_t j) {
+            return data[i * cols + j];
+        }
+        const T& operator()(const size_t i, const size_t j) const {
+            return data[i * cols + j];
+        }
+
+        // Access to the element at `(i,j)`, throwing a `std::out_of_range` if it isn't inside the region.
+        T& at(const size_t i, const size_t j) {
+            if (i < i_lo || i >= i_hi || j < j_lo || j >= j_hi) {
+                throw std::out_of_range("tried to access an element outside of the locked region");
+            }
+            return data[i * cols + j];
+        }
+        const T& at(const size_t i, const size_t j) const {
+            return const_cast<Region*>(this)->at(i, j);
+        }
+    };
+
+    // Default constructor: an empty `0` x `0` array.
+    ConcurrentArray2D() {
+        make_stripes(1);
+        return;
+    }
+
+    // Creates a `rows` x `cols` array of `value`s, with one lock per tile up to at most `max_stripes` locks.
+    ConcurrentArray2D(const size_t rows, const size_t cols, const T& value = T(), const size_t max_stripes = 1024)
+    : data(rows * cols, value), row_ct(rows), col_ct(cols) {
+        make_stripes(max_stripes);
+        return;
+    }
+
+    // Copies an `Array2D`, with one lock per tile up to at most `max_stripes` locks.
+    explicit ConcurrentArray2D(const Array2D<T>& dense, const size_t max_stripes = 1024)
+    : row_ct(dense.rowCount()), col_ct(dense.colCount()) {
+        data.reserve(row_ct * col_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            const auto row = dense[i];
+            for (size_t j=0; j < col_ct; ++j) {
+                data.push_back(row[j]);
+            }
+        }
+        make_stripes(max_stripes);
+        return;
+    }
+
+    // The locks can't be shared, so neither can the array; it may be moved while no other thread is using it.
+    ConcurrentArray2D(const ConcurrentArray2D&) = delete;
+    ConcurrentArray2D& operator=(const ConcurrentArray2D&) = delete;
+    ConcurrentArray2D(ConcurrentArray2D&&) noexcept = default;
+    ConcurrentArray2D& operator=(ConcurrentArray2D&&) noexcept = default;
+
+    /* ============================
+        Attributes
+    ============================= */
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+    size_t size() const { return row_ct * col_ct; }
+    bool empty() const { return size() == 0; }
+    size_t stripe_count() const { return stripe_ct; }
+
+    /* ============================
+        Locked Access
+    ============================= */
+    // Locks every tile that `[i_start, i_past_end) x [j_start, j_past_end)` overlaps for writing, calls `func(region)` with a `Region&` over it, and returns whatever `func` returns.
+    // Only threads touching the same tiles (or tiles that share a lock) wait for each other. Locks are always taken in increasing order, so concurrent calls never deadlock, but `func` must not call `with_region` or `read_region` itself.
+    // Throws a `std::out_of_range` if the region isn't within the array.
+    template <class Func>
+    decltype(auto) with_region(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end, Func&& func) {
+        check_region(i_start, j_start, i_past_end, j_past_end);
+        const RegionLock<false> held(stripes.get(), region_stripes(i_start, j_start, i_past_end, j_past_end));
+        Region region(data.data(), col_ct, i_start, j_start, i_past_end, j_past_end);
+        return func(region);
+    }
+
+    // As `with_region`, but only locks the tiles for reading (so any number of readers may share them) and passes `func` a `const Region&`.
+    template <class Func>
+    decltype(auto) read_region(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end, Func&& func) const {
+        check_region(i_start, j_start, i_past_end, j_past_end);
+        const RegionLock<true> held(stripes.get(), region_stripes(i_start, j_start, i_past_end, j_past_end));
+        const Region region(const_cast<T*>(data.data()), col_ct, i_start, j_start, i_past_end, j_past_end);
+        return func(region);
+    }
+
+    // Returns a copy of the element at `(i,j)`, taking its tile's lock for reading. Throws a `std::out_of_range` if there is no such element.
+    T get(const size_t i, const size_t j) const {
+        check_cell(i, j);
+        const std::shared_lock<std::shared_mutex> held(stripes[stripe_of(i, j)].lock);
+        return data[i * col_ct + j];
+    }
+
+    // Sets the element at `(i,j)` to `value`, taking its tile's lock for writing. Throws a `std::out_of_range` if there is no such element.
+    ConcurrentArray2D& set(const size_t i, const size_t j, const T& value) {
+        check_cell(i, j);
+        const std::lock_guard<std::shared_mutex> held(stripes[stripe_of(i, j)].lock);
+        data[i * col_ct + j] = value;
+        return *this;
+    }
+
+    /* ============================
+        Lock-Free Cell Operations
+    ============================= */
+    // These take no lock, and follow `std::atomic`'s semantics for the given memory order. They require an arithmetic `T`, and throw a `std::out_of_range` if there is no element at `(i,j)`.
+
+    // Atomically adds `delta` to the element at `(i,j)`, returning its previous value.
+    T fetch_add(const size_t i, const size_t j, const T delta, const std::memory_order order = std::memory_order_seq_cst) {
+        static_assert(std::is_arithmetic<T>::value, "atomic cell operations need an arithmetic element type");
+        check_cell(i, j);
+        return cell_fetch_add(data[i * col_ct + j], delta, order);
+    }
+
+    // Atomically replaces the element at `(i,j)` with `desired` if it equals `expected`, returning `true`; otherwise loads it into `expected` and returns `false`.
+    bool compare_exchange(const size_t i, const size_t j, T& expected, const T desired, const std::memory_order order = std::memory_order_seq_cst) {
+        static_assert(std::is_arithmetic<T>::value, "atomic cell operations need an arithmetic element type");
+        check_cell(i, j);
+        return cell_compare_exchange(data[i * col_ct + j], expected, desired, order);
+    }
+
+    // Atomically reads the element at `(i,j)`.
+    T load(const size_t i, const size_t j, const std::memory_order order = std::memory_order_seq_cst) const {
+        static_assert(std::is_arithmetic<T>::value, "atomic cell operations need an arithmetic element type");
+        check_cell(i, j);
+        return cell_load(data[i * col_ct + j], order);
+    }
+
+    // Atomically writes `value` to the element at `(i,j)`.
+    ConcurrentArray2D& store(const size_t i, const size_t j, const T value, const std::memory_order order = std::memory_order_seq_cst) {
+        static_assert(std::is_arithmetic<T>::value, "atomic cell operations need an arithmetic element type");
+        check_cell(i, j);
+        cell_store(data[i * col_ct + j], value, order);
+        return *this;
+    }
+
+    /* ============================
+        Whole-Array Operations
+    ============================= */
+    // These go one tile at a time, each under that tile's lock, so that other threads can keep working on the rest of the array meanwhile.
+    // Each tile is seen consistently, but the array as a whole is not a single snapshot if other threads are writing to it.
+
+    // Map a unary function of type `T -> T` onto this array, changing each value in-place.
+    ConcurrentArray2D& map_inplace(const std::function<T(T)>& func) {
+        for (size_t ti=0; ti < row_ct; ti += TILE) {
+            for (size_t tj=0; tj < col_ct; tj += TILE) {
+                with_region(ti, tj, std::min(row_ct, ti + TILE), std::min(col_ct, tj + TILE), [&func](Region& region) {
+                    for (size_t i=region.i_start(); i < region.i_past_end(); ++i) {
+                        for (size_t j=region.j_start(); j < region.j_past_end(); ++j) {
+                            region(i, j) = func(region(i, j));
+                        }
+                    }
+                });
+            }
+        }
+        return *this;
+    }
+
+    // Sums all elements in the array. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum() const {
+        T total = T();
+        for (size_t ti=0; ti < row_ct; ti += TILE) {
+            for (size_t tj=0; tj < col_ct; tj += TILE) {
+                read_region(ti, tj, std::min(row_ct, ti + TILE), std::min(col_ct, tj + TILE), [&total](const Region& region) {
+                    for (size_t i=region.i_start(); i < region.i_past_end(); ++i) {
+                        for (size_t j=region.j_start(); j < region.j_past_end(); ++j) {
+                            total = total + region(i, j);
+                        }
+                    }
+                });
+            }
+        }
+        return total;
+    }
+
+    // Copies the contents out into an `Array2D`, locking the whole array for reading while it does so (so the copy is a consistent snapshot).
+    Array2D<T> to_array() const {
+        if (empty()) {
+            return Array2D<T>();
+        }
+        return read_region(0, 0, row_ct, col_ct, [this](const Region& region) {
+            std::vector<std::vector<T>> rows;
+            rows.reserve(row_ct);
+            for (size_t i=0; i < row_ct; ++i) {
+                rows.emplace_back(&region(i, 0), &region(i, 0) + col_ct);
+            }
+            return Array2D<T>(std::move(rows));
+        });
+    }
+};
+
+};  // end namespace
+#endif
@@ -0,0 +1,444 @@
+#ifndef YELLE_COW_ARRAY2D
+#define YELLE_COW_ARRAY2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <atomic>
+#include <memory>
+
+namespace yelle {
+
+// A 2D array with copy-on-write storage, for cheaply branching off many variants of one large array that each change only a little of it.
+// The rows are held through a shared table of shared rows, so copying a `CowArray2D` is O(1): the copy and the original share everything until one of them is written to.
+// A write then copies only what it touches: first the table of rows (one pointer per row, and only once per copy), then the row being written.
+// Rows stay shared among any number of copies for as long as none of them writes to that row; rows filled with one value are even shared within a single array.
+// As with the standard containers, distinct copies may be used from different threads at once, but a single copy should only be used by one thread at a time (unless it is only being read).
+template <class T>
+class CowArray2D {
+protected:
+    using Row = std::vector<T>;
+    using RowTable = std::vector<std::shared_ptr<Row>>;
+
+    // The rows of the array, in physical order. Null for an empty array (including a moved-from one).
+    std::shared_ptr<RowTable> table;
+    size_t col_ct = 0;
+
+    // Logical origin, as in `Array2D`: the element at logical `[i,j]` is stored at `(*table)[(i + row_origin) % rowCount()]->at((j + col_origin) % colCount())`.
+    // This keeps `shift_horizontal` and `shift_vertical` O(1), and means they never un-share anything.
+    size_t row_origin = 0;
+    size_t col_origin = 0;
+
+    size_t phys_row(const size_t i) const {
+        const size_t k = i + row_origin;
+        return (k >= table->size() ? k - table->size() : k);
+    }
+
+    size_t phys_col(const size_t j) const {
+        const size_t k = j + col_origin;
+        return (k >= col_ct ? k - col_ct : k);
+    }
+
+    // Whether the object behind `ptr` has no other owners, so that it can be written to in place.
+    template <class P>
+    static bool sole_owner(const std::shared_ptr<P>& ptr) {
+        if (ptr.use_count() != 1) {
+            return false;
+        }
+        // pairs with the release in the reference-count decrement of whichever copy let go of it last, so that its reads of the object come before our writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    // Makes the table of rows this array's own (copying the pointers, not the rows) and returns it.
+    RowTable& writable_table() {
+        if (!table) {
+            table = std::make_shared<RowTable>();
+        } else if (!sole_owner(table)) {
+            table = std::make_shared<RowTable>(*table);
+        }
+        return *table;
+    }
+
+    // Makes physical row `p` this array's own, copying it if it's shared, and returns it.
+    Row& writable_row(const size_t p) {
+        std::shared_ptr<Row>& row = writable_table()[p];
+        if (!sole_owner(row)) {
+            row = std::make_shared<Row>(*row);
+        }
+        return *row;
+    }
+
+    // Physically rotates the table so that the logical row origin is back at `0`. Only moves row pointers.
+    void normalize_row_origin() {
+        if (row_origin != 0) {
+            RowTable& rows = writable_table();
+            std::rotate(rows.begin(), rows.begin() + static_cast<long>(row_origin), rows.end());
+            row_origin = 0;
+        }
+    }
+
+    // Converts a row given in logical order into physical order, to match the column origin.
+    std::shared_ptr<Row> physical_row(Row&& logical) const {
+        if (col_origin != 0) {
+            std::rotate(logical.begin(), logical.end() - static_cast<long>(col_origin), logical.end());
+        }
+        return std::make_shared<Row>(std::move(logical));
+    }
+
+    // Applies `func` in-place to every element of physical row `p`. A shared row is mapped straight into its replacement instead of being copied first.
+    template <class Func>
+    void map_row_inplace(const size_t p, const Func& func) {
+        std::shared_ptr<Row>& row = writable_table()[p];
+        if (sole_owner(row)) {
+            for (T& elem : *row) {
+                elem = func(elem);
+            }
+        } else {
+            auto mapped = std::make_shared<Row>();
+            mapped->reserve(row->size());
+            for (const T& elem : *row) {
+                mapped->push_back(func(elem));
+            }
+            row = std::move(mapped);
+        }
+    }
+
+public:
+    // Default constructor: an empty `0` x `0` array.
+    CowArray2D() {
+        return;
+    }
+
+    // Creates a `rows` x `cols` array of `value`s. All the rows share one stored row until they are written to.
+    CowArray2D(const size_t rows, const size_t cols, const T& value = T()) {
+        fill(rows, cols, value);
+        return;
+    }
+
+    // Copies an `Array2D`, one unshared row per row.
+    explicit CowArray2D(const Array2D<T>& dense) : col_ct(dense.colCount()) {
+        const size_t rows = dense.rowCount();
+        table = std::make_shared<RowTable>();
+        table->reserve(rows);
+        for (size_t i=0; i < rows; ++i) {
+            auto row = std::make_shared<Row>();
+            row->reserve(col_ct);
+            const auto source = dense[i];
+            for (size_t j=0; j < col_ct; ++j) {
+                row->push_back(source[j]);
+            }
+            table->push_back(std::move(row));
+        }
+        return;
+    }
+
+    // Copying (including with `clone`) is O(1), and copies share all storage until written to; moving leaves the source empty.
+    CowArray2D(const CowArray2D&) = default;
+    CowArray2D(CowArray2D&&) noexcept = default;
+    CowArray2D& operator=(const CowArray2D&) = default;
+    CowArray2D& operator=(CowArray2D&&) noexcept = default;
+
+    // Returns a copy of this array, for branching off a method chain. O(1), like any copy.
+    CowArray2D clone() const {
+        return CowArray2D(*this);
+    }
+
+    /* ============================
+        Attributes & Element Access
+    ============================= */
+    size_t rowCount() const { return (table ? table->size() : 0); }
+    size_t colCount() const { return (rowCount() == 0 ? 0 : col_ct); }
+    size_t size() const { return rowCount() * colCount(); }
+    bool empty() const { return size() == 0; }
+
+    // Number of this array's rows that aren't shared with any other array (or elsewhere in this one), i.e. that have been copied by writes.
+    size_t owned_row_count() const {
+        if (!table) {
+            return 0;
+        }
+        const bool own_table = (table.use_count() == 1);
+        size_t owned = 0;
+        for (const std::shared_ptr<Row>& row : *table) {
+            owned += (own_table && row.use_count() == 1 ? 1 : 0);
+        }
+        return owned;
+    }
+
+    // Whether this array and `other` still share their table of rows, as an untouched copy does.
+    bool shares_storage_with(const CowArray2D& other) const {
+        return table != nullptr && table == other.table;
+    }
+
+    // Read-only access to the element at `(i,j)`, without bounds checking. Never copies anything.
+    const T& operator()(const size_t i, const size_t j) const {
+        return (*(*table)[phys_row(i)])[phys_col(j)];
+    }
+
+    // Read-only access to the element at `(i,j)`, throwing a `std::out_of_range` if there is no such element.
+    const T& at(const size_t i, const size_t j) const {
+        if (i >= rowCount() || j >= colCount()) {
+            throw std::out_of_range("tried to access nonexistent row or column of copy-on-write array");
+        }
+        return (*this)(i, j);
+    }
+
+    // Returns a `std::optional` copy of the element at `(i,j)`. If there is no element at `(i,j)`, then returns a null optional.
+    std::optional<T> safe_look(const size_t i, const size_t j) const noexcept {
+        if (i >= rowCount() || j >= colCount()) {
+            return std::optional<T>();
+        }
+        return std::optional<T>((*this)(i, j));
+    }
+
+    // Writable access to the element at `(i,j)`, throwing a `std::out_of_range` if there is no such element.
+    // Copies row `i` first if it's shared. The reference stays valid until this array is next copied or changed.
+    T& mutable_at(const size_t i, const size_t j) {
+        if (i >= rowCount() || j >= colCount()) {
+            throw std::out_of_range("tried to access nonexistent row or column of copy-on-write array");
+        }
+        return writable_row(phys_row(i))[phys_col(j)];
+    }
+
+    // Sets the element at `(i,j)` to `value`, copying row `i` first if it's shared. Throws a `std::out_of_range` if there is no such element.
+    CowArray2D& set(const size_t i, const size_t j, const T& value) {
+        mutable_at(i, j) = value;
+        return *this;
+    }
+
+    /* ============================
+        Building & Rearranging
+    ============================= */
+    // Empties the array, then fills it as a `rows` x `cols` array of `value`s, with all of the rows sharing one stored row.
+    CowArray2D& fill(const size_t rows, const size_t cols, const T& value) {
+        row_origin = 0;
+        col_origin = 0;
+        col_ct = cols;
+        if (rows == 0 || cols == 0) {
+            table.reset();
+            return *this;
+        }
+        table = std::make_shared<RowTable>(rows, std::make_shared<Row>(cols, value));
+        return *this;
+    }
+
+    // Insert a vector `new_row` as a new row in the array. Moves row pointers only; no existing row is copied.
+    // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()` are valid.
+    // Will throw a `std::length_error` if new row does not have the same length as `colCount()`.
+    CowArray2D& insert_row(const size_t position, std::vector<T> new_row) {
+        if (position > rowCount()) {
+            fprintf(stderr, "Attempted to insert a row at index %zu into an array with only %zu rows!\n", position, rowCount());
+            throw std::out_of_range("tried to add row at too-high index value");
+        } else if (new_row.size() != colCount() && size() != 0) {
+            fprintf(stderr, "Attempted to insert a row of length %zu into an array with row-length %zu!\n", new_row.size(), colCount());
+            throw std::length_error("tried to add row of incorrect length");
+        }
+        if (size() == 0) {
+            // an empty array takes on the new row's length
+            table.reset();
+            col_ct = new_row.size();
+            col_origin = 0;
+        }
+        normalize_row_origin();
+        RowTable& rows = writable_table();
+        rows.insert(rows.begin() + static_cast<long>(position), physical_row(std::move(new_row)));
+        return *this;
+    }
+
+    // Appends a vector `new_row` as a new row at the bottom of the array. Throws as `insert_row`.
+    CowArray2D& append_row(std::vector<T> new_row) {
+        return insert_row(rowCount(), std::move(new_row));
+    }
+
+    // Delete the row at index `i`. Moves row pointers only.
+    // Will throw a `std::out_of_range` error if at an invalid position--only indices from `0` to `rowCount()-1` are valid.
+    CowArray2D& delete_row(const size_t i) {
+        return delete_rows(i, i+1);
+    }
+
+    // Delete all rows in the range `[i_start, i_past_end)`. Note that `i_past_end` is excluded. Moves row pointers only.
+    // Will throw a `std::out_of_range` error if at an invalid position. If indices are valid, but `i_start >= i_past_end`, then silently no deletion occurs.
+    CowArray2D& delete_rows(const size_t i_start, const size_t i_past_end) {
+        if (i_past_end > rowCount()) {
+            fprintf(stderr, "Tried to delete rows [%zu, %zu) from an array with %zu rows!\n", i_start, i_past_end, rowCount());
+            throw std::out_of_range("cannot delete row outside of valid range");
+        }
+        if (i_start >= i_past_end) {
+            return *this;
+        }
+        normalize_row_origin();
+        RowTable& rows = writable_table();
+        rows.erase(rows.begin() + static_cast<long>(i_start), rows.begin() + static_cast<long>(i_past_end));
+        return *this;
+    }
+
+    // Swaps rows `i1` and `i2`. Moves row pointers only. Throws a `std::out_of_range` if either row doesn't exist.
+    CowArray2D& swap_rows(const size_t i1, const size_t i2) {
+        if (i1 >= rowCount() || i2 >= rowCount()) {
+            throw std::out_of_range("tried to swap nonexistent rows of copy-on-write array");
+        }
+        RowTable& rows = writable_table();
+        std::swap(rows[phys_row(i1)], rows[phys_row(i2)]);
+        return *this;
+    }
+
+    // Shifts the array horizontally so that the element at `[i,j]` is moved to `[i, (j+shift_j) % colCount]`, looping around as `Array2D::shift_horizontal` does.
+    // O(1), and shares everything it shared before.
+    CowArray2D& shift_horizontal(long shift_j) noexcept {
+        const long cols = static_cast<long>(colCount());
+        if (cols == 0) {
+            return *this;
+        }
+        shift_j = -(shift_j % cols);
+        if (shift_j < 0) {
+            shift_j = cols + shift_j;
+        }
+        col_origin = (col_origin + static_cast<size_t>(shift_j)) % static_cast<size_t>(cols);
+        return *this;
+    }
+
+    // Shifts the array vertically so that the element at `[i,j]` is moved to `[(i+shift_i) % rowCount, j]`, looping around as `Array2D::shift_vertical` does.
+    // O(1), and shares everything it shared before.
+    CowArray2D& shift_vertical(long shift_i) noexcept {
+        const long rows = static_cast<long>(rowCount());
+        if (rows == 0) {
+            return *this;
+        }
+        shift_i = -(shift_i % rows);
+        if (shift_i < 0) {
+            shift_i = rows + shift_i;
+        }
+        row_origin = (row_origin + static_cast<size_t>(shift_i)) % static_cast<size_t>(rows);
+        return *this;
+    }
+
+    // Transposes the array, moving the element at `(i,j)` to `(j,i)`. Every row is new afterwards, so nothing stays shared.
+    CowArray2D& transpose() {
+        const size_t rows = rowCount();
+        const size_t cols = colCount();
+        if (rows * cols == 0) {
+            return *this;
+        }
+        auto transposed = std::make_shared<RowTable>();
+        transposed->reserve(cols);
+        for (size_t j=0; j < cols; ++j) {
+            auto row = std::make_shared<Row>();
+            row->reserve(rows);
+            for (size_t i=0; i < rows; ++i) {
+                row->push_back((*this)(i, j));
+            }
+            transposed->push_back(std::move(row));
+        }
+        table = std::move(transposed);
+        col_ct = rows;
+        row_origin = 0;
+        col_origin = 0;
+        return *this;
+    }
+
+    /* ============================
+        Calculations
+    ============================= */
+    // Map a unary function of type `T -> T` onto this array, changing each value in-place. Shared rows are replaced by mapped copies in the same pass.
+    CowArray2D& map_inplace(const std::function<T(T)>& func) {
+        return map_inplace_rows(0, rowCount(), func);
+    }
+
+    // Map a unary function of type `T -> T` in-place onto rows `[i_start, i_past_end)` only, leaving the other rows (and whatever shares them) alone.
+    // Will throw a `std::out_of_range` error if `i_past_end > rowCount()`.
+    CowArray2D& map_inplace_rows(const size_t i_start, const size_t i_past_end, const std::function<T(T)>& func) {
+        if (i_past_end > rowCount()) {
+            fprintf(stderr, "Tried to map rows [%zu, %zu) of an array with %zu rows!\n", i_start, i_past_end, rowCount());
+            throw std::out_of_range("cannot map rows outside of valid range");
+        }
+        for (size_t i=i_start; i < i_past_end; ++i) {
+            map_row_inplace(phys_row(i), func);
+        }
+        return *this;
+    }
+
+    // Folding from the left, in row-major order. Does not throw if the array is empty (the accumulator is returned as-is).
+    template <class S>
+    S foldl(const std::function<S(S,T)>& func, S accumulator) const {
+        for (size_t i=0; i < rowCount(); ++i) {
+            const Row& row = *(*table)[phys_row(i)];
+            for (size_t j=0; j < col_ct; ++j) {
+                accumulator = func(accumulator, row[phys_col(j)]);
+            }
+        }
+        return accumulator;
+    }
+
+    // Sums all elements in the array. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum() const {
+        T total = T();
+        if (table) {
+            for (const std::shared_ptr<Row>& row : *table) {
+                for (const T& elem : *row) {
+                    total = total + elem;
+                }
+            }
+        }
+        return total;
+    }
+
+    // Sums all elements in row `row_i`. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum_row(const size_t row_i) const {
+        if (row_i >= rowCount()) {
+            throw std::out_of_range("tried to sum nonexistent row of copy-on-write array");
+        }
+        T total = T();
+        for (const T& elem : *(*table)[phys_row(row_i)]) {
+            total = total + elem;
+        }
+        return total;
+    }
+
+    // Sums all elements in column `column_j`. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum_col(const size_t column_j) const {
+        if (column_j >= colCount()) {
+            throw std::out_of_range("tried to sum nonexistent column of copy-on-write array");
+        }
+        T total = T();
+        const size_t p = phys_col(column_j);
+        for (const std::shared_ptr<Row>& row : *table) {
+            total = total + (*row)[p];
+        }
+        return total;
+    }
+
+    /* ============================
+        Conversion
+    ============================= */
+    // Produces a `std::string` representation of the array in the same format as `Array2D::to_string`.
+    std::string to_string() const {
+        std::stringstream oss;
+        for (size_t i=0; i < rowCount(); ++i) {
+            for (size_t j=0; j < colCount(); ++j) {
+                oss << (*this)(i, j) << "\t";
+            }
+            oss << "\n";
+        }
+        return oss.str();
+    }
+
+    // Copies the contents out into an `Array2D`.
+    Array2D<T> to_array() const {
+        std::vector<std::vector<T>> rows;
+        rows.reserve(rowCount());
+        for (size_t i=0; i < rowCount(); ++i) {
+            const Row& row = *(*table)[phys_row(i)];
+            rows.emplace_back();
+            rows.back().reserve(col_ct);
+            for (size_t j=0; j < col_ct; ++j) {
+                rows.back().push_back(row[phys_col(j)]);
+            }
+        }
+        return Array2D<T>(std::move(rows));
+    }
+};
+
+};  // end namespace
+#endif
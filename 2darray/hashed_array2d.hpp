@@ -0,0 +1,428 @@
+#ifndef YELLE_HASHED_ARRAY2D
+#define YELLE_HASHED_ARRAY2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <cstdint>
+
+namespace yelle {
+
+// An `Array2D` that keeps a hash of its whole contents up to date as it changes, so that `hash()` is O(1), e.g. for spotting repeated states in a simulation.
+// The hash is `sum(v[i,j] * BASE_I^i * BASE_J^j)` modulo `2^61 - 1` (see `hash61`), over the scrambled `std::hash` `v` of every element, mixed with the dimensions.
+// Along with it, the hash of each row on its own is kept, so that changes move the hash by however much they changed it instead of rehashing the array:
+// writing a cell (through `set`, or the proxies returned by `operator[]`) is O(1); the shifts and the row/column inserts and deletes only read the cells they add or remove (or, if fewer, the cells on the other side of them), plus O(rowCount()) for the row hashes.
+// Reading goes through `array()`, a `const Array2D<T>&`; every change goes through the methods here, so that none is missed.
+template <class T>
+class HashedArray2D {
+    static_assert(std::is_default_constructible<std::hash<T>>::value, "HashedArray2D needs std::hash<T>");
+
+protected:
+    Array2D<T> data;
+    std::vector<uint64_t> row_hash;     // `row_hash[i] = sum(v[i,j] * BASE_J^j)`
+    uint64_t total = 0;                 // `sum(row_hash[i] * BASE_I^i)`
+    std::vector<uint64_t> pow_i{1};     // `pow_i[n] = BASE_I^n`, for `n <= rowCount()` at least
+    std::vector<uint64_t> pow_j{1};     // `pow_j[n] = BASE_J^n`, for `n <= colCount()` at least
+
+    static uint64_t cell_hash(const T& value) {
+        return hash61::reduce(hash61::mix64(static_cast<uint64_t>(std::hash<T>()(value))));
+    }
+
+    // Extends the power tables to cover the array's current dimensions.
+    void grow_powers() {
+        while (pow_i.size() <= data.rowCount()) {
+            pow_i.push_back(hash61::mul(pow_i.back(), hash61::BASE_I));
+        }
+        while (pow_j.size() <= data.colCount()) {
+            pow_j.push_back(hash61::mul(pow_j.back(), hash61::BASE_J));
+        }
+    }
+
+    // `sum(v[i,j] * BASE_J^j)` over `j` in `[j_start, j_past_end)`.
+    uint64_t row_part(const size_t i, const size_t j_start, const size_t j_past_end) const {
+        const auto row = data[i];
+        uint64_t h = 0;
+        for (size_t j=j_start; j < j_past_end; ++j) {
+            h = hash61::add(h, hash61::mul(cell_hash(row[j]), pow_j[j]));
+        }
+        return h;
+    }
+
+    // `sum(BASE_J^j)` over `j` in `[j_start, j_past_end)`: the row hash of a run of elements that hash to `1`.
+    uint64_t power_run(const size_t j_start, const size_t j_past_end) const {
+        uint64_t h = 0;
+        for (size_t j=j_start; j < j_past_end; ++j) {
+            h = hash61::add(h, pow_j[j]);
+        }
+        return h;
+    }
+
+    void recompute_total() {
+        total = 0;
+        for (size_t i=0; i < row_hash.size(); ++i) {
+            total = hash61::add(total, hash61::mul(row_hash[i], pow_i[i]));
+        }
+    }
+
+    // Rehashes every cell.
+    void rebuild() {
+        grow_powers();
+        row_hash.resize(data.rowCount());
+        for (size_t i=0; i < data.rowCount(); ++i) {
+            row_hash[i] = row_part(i, 0, data.colCount());
+        }
+        recompute_total();
+    }
+
+public:
+    // Proxy for one cell, returned by `operator[]`: reads as a `const T&`, and assigning to it goes through `set`.
+    class CellRef {
+    protected:
+        HashedArray2D* owner;
+        size_t i;
+        size_t j;
+
+    public:
+        CellRef(HashedArray2D* array, const size_t row, const size_t col) : owner(array), i(row), j(col) {
+            return;
+        }
+
+        operator const T&() const { return owner->data[i][j]; }
+        const T& get() const { return owner->data[i][j]; }
+
+        CellRef& operator=(const T& value) {
+            owner->set(i, j, value);
+            return *this;
+        }
+        CellRef& operator=(const CellRef& other) {
+            return *this = other.get();
+        }
+        template <class U> CellRef& operator+=(const U& rhs) { return *this = get() + rhs; }
+        template <class U> CellRef& operator-=(const U& rhs) { return *this = get() - rhs; }
+        template <class U> CellRef& operator*=(const U& rhs) { return *this = get() * rhs; }
+        template <class U> CellRef& operator/=(const U& rhs) { return *this = get() / rhs; }
+    };
+
+    // Proxy for one row, returned by `operator[]`, so that `myarray[i][j]` is a `CellRef`.
+    class RowRef {
+    protected:
+        HashedArray2D* owner;
+        size_t i;
+
+    public:
+        RowRef(HashedArray2D* array, const size_t row) : owner(array), i(row) {
+            return;
+        }
+
+        CellRef operator[](const size_t j) const { return CellRef(owner, i, j); }
+        size_t size() const { return owner->colCount(); }
+    };
+
+    // Default constructor: an empty array.
+    HashedArray2D() {
+        return;
+    }
+
+    // Creates a `rows` x `cols` array of `value`s.
+    HashedArray2D(const size_t rows, const size_t cols, const T& value = T()) {
+        fill(rows, cols, value);
+        return;
+    }
+
+    // Copies an `Array2D`, hashing all of it once.
+    explicit HashedArray2D(const Array2D<T>& initial) : data(initial) {
+        rebuild();
+        return;
+    }
+
+    // Takes over an `Array2D`, hashing all of it once.
+    explicit HashedArray2D(Array2D<T>&& initial) : data(std::move(initial)) {
+        rebuild();
+        return;
+    }
+
+    /* ============================
+        Reading
+    ============================= */
+    // Hash of the whole array, in O(1). Equal arrays (same dimensions and elements, by `std::hash<T>`) always have equal hashes, and different ones almost never do.
+    uint64_t hash() const {
+        return hash61::mix64(total + hash61::mix64(data.rowCount() * 0x9e3779b97f4a7c15 ^ data.colCount()));
+    }
+
+    // The array itself, for reading through any `const` method of `Array2D`.
+    const Array2D<T>& array() const {
+        return data;
+    }
+
+    size_t rowCount() const { return data.rowCount(); }
+    size_t colCount() const { return data.colCount(); }
+    size_t size() const { return data.size(); }
+    bool empty() const { return data.empty(); }
+
+    // `myarray[i][j]` reads the element at `[i,j]`, and writes it (through `set`) if assigned to. No bounds checking.
+    RowRef operator[](const size_t i) {
+        return RowRef(this, i);
+    }
+
+    // `const` subscript operator: `myarray[i][j]` is the element at `[i,j]`.
+    auto operator[](const size_t i) const {
+        return data[i];
+    }
+
+    // `const`-access to the element at `[i,j]`, with bounds checking.
+    const T& at(const size_t i, const size_t j) const {
+        return data.at(i, j);
+    }
+
+    /* ============================
+        Changing Cells
+    ============================= */
+    // Sets the element at `[i,j]` to `value`, in O(1). Throws a `std::out_of_range` if `[i,j]` is out of range.
+    HashedArray2D& set(const size_t i, const size_t j, const T& value) {
+        T& cell = data.at(i, j);
+        const uint64_t delta = hash61::mul(hash61::sub(cell_hash(value), cell_hash(cell)), pow_j[j]);
+        cell = value;
+        row_hash[i] = hash61::add(row_hash[i], delta);
+        total = hash61::add(total, hash61::mul(delta, pow_i[i]));
+        return *this;
+    }
+
+    // Replaces every element with `func` of itself, rehashing each as it goes: one pass over the cells, not a map followed by a rehash.
+    HashedArray2D& map_inplace(const std::function<T(T)>& func) {
+        const size_t col_ct = colCount();
+        total = 0;
+        for (size_t i=0; i < rowCount(); ++i) {
+            auto row = data[i];
+            uint64_t h = 0;
+            for (size_t j=0; j < col_ct; ++j) {
+                T& cell = row[j];
+                cell = func(cell);
+                h = hash61::add(h, hash61::mul(cell_hash(cell), pow_j[j]));
+            }
+            row_hash[i] = h;
+            total = hash61::add(total, hash61::mul(h, pow_i[i]));
+        }
+        return *this;
+    }
+
+    // Empties the array, then fills it as a `rows` x `cols` array of `value`s. The hash takes O(rows + cols), since every row hashes alike.
+    HashedArray2D& fill(const size_t rows, const size_t cols, const T& value) {
+        data.fill(rows, cols, value);
+        grow_powers();
+        const uint64_t one_row = hash61::mul(cell_hash(value), power_run(0, colCount()));
+        row_hash.assign(rows, one_row);
+        recompute_total();
+        return *this;
+    }
+
+    // Calls `func` with the underlying `Array2D<T>&`, for any change not covered here, then rehashes all of it.
+    template <class Func>
+    HashedArray2D& edit(Func&& func) {
+        func(data);
+        rebuild();
+        return *this;
+    }
+
+    /* ============================
+        Shifting
+    ============================= */
+    // Shifts the array horizontally so that the element at `[i,j]` is moved to `[i, (j+shift_j) % colCount]`, as `Array2D::shift_horizontal`.
+    // Reads the `shift_j` elements per row that loop around (or the rest, if fewer).
+    HashedArray2D& shift_horizontal(long shift_j) {
+        const long col_ct = static_cast<long>(colCount());
+        if (col_ct == 0) {
+            return *this;
+        }
+        shift_j %= col_ct;
+        if (shift_j < 0) {
+            shift_j += col_ct;
+        }
+        if (shift_j == 0) {
+            return *this;
+        }
+        const size_t m = static_cast<size_t>(col_ct);
+        const size_t k = static_cast<size_t>(shift_j);
+        // elements that don't loop around gain a factor of `BASE_J^k`, and those that do gain `BASE_J^(k-m)`
+        const uint64_t inv_pow_m = hash61::inverse(pow_j[m]);
+        for (size_t i=0; i < rowCount(); ++i) {
+            if (k <= m - k) {
+                const uint64_t wrapped = row_part(i, m - k, m);
+                row_hash[i] = hash61::mul(pow_j[k], hash61::add(row_hash[i], hash61::mul(hash61::sub(inv_pow_m, 1), wrapped)));
+            } else {
+                const uint64_t staying = row_part(i, 0, m - k);
+                row_hash[i] = hash61::mul(hash61::mul(inv_pow_m, pow_j[k]), hash61::add(row_hash[i], hash61::mul(hash61::sub(pow_j[m], 1), staying)));
+            }
+        }
+        data.shift_horizontal(shift_j);
+        recompute_total();
+        return *this;
+    }
+
+    // Shifts the array vertically so that the element at `[i,j]` is moved to `[(i+shift_i) % rowCount, j]`, as `Array2D::shift_vertical`. Reads no elements at all.
+    HashedArray2D& shift_vertical(long shift_i) {
+        const long row_ct = static_cast<long>(rowCount());
+        if (row_ct == 0) {
+            return *this;
+        }
+        shift_i %= row_ct;
+        if (shift_i < 0) {
+            shift_i += row_ct;
+        }
+        std::rotate(row_hash.begin(), row_hash.end() - shift_i, row_hash.end());
+        data.shift_vertical(shift_i);
+        recompute_total();
+        return *this;
+    }
+
+    // Shifts the array horizontally so that the element at `[i,j]` is moved to `[i, j+shift_j]`, filling the gap with `filler`, as `Array2D::shift_horizontal_fill`.
+    // Reads only the elements shifted out.
+    HashedArray2D& shift_horizontal_fill(long shift_j, const T& filler) {
+        const long col_ct = static_cast<long>(colCount());
+        if (col_ct == 0 || shift_j == 0) {
+            return *this;
+        }
+        shift_j = std::clamp<long>(shift_j, -col_ct, col_ct);
+        const size_t m = static_cast<size_t>(col_ct);
+        const size_t k = static_cast<size_t>(std::abs(shift_j));
+        // the elements kept gain a factor of `BASE_J^shift_j`
+        const uint64_t factor = (shift_j > 0) ? pow_j[k] : hash61::pow(hash61::inverse(hash61::BASE_J), k);
+        const uint64_t filled = (shift_j > 0) ? hash61::mul(cell_hash(filler), power_run(0, k)) : hash61::mul(cell_hash(filler), power_run(m - k, m));
+        for (size_t i=0; i < rowCount(); ++i) {
+            const uint64_t dropped = (shift_j > 0) ? row_part(i, m - k, m) : row_part(i, 0, k);
+            row_hash[i] = hash61::add(hash61::mul(factor, hash61::sub(row_hash[i], dropped)), filled);
+        }
+        data.shift_horizontal_fill(shift_j, filler);
+        recompute_total();
+        return *this;
+    }
+
+    // Shifts the array vertically so that the element at `[i,j]` is moved to `[i+shift_i, j]`, filling the gap with `filler`, as `Array2D::shift_vertical_fill`. Reads no elements at all.
+    HashedArray2D& shift_vertical_fill(long shift_i, const T& filler) {
+        const long row_ct = static_cast<long>(rowCount());
+        if (row_ct == 0 || shift_i == 0) {
+            return *this;
+        }
+        shift_i = std::clamp<long>(shift_i, -row_ct, row_ct);
+        const size_t k = static_cast<size_t>(std::abs(shift_i));
+        const uint64_t filled = hash61::mul(cell_hash(filler), power_run(0, colCount()));
+        if (shift_i > 0) {
+            row_hash.erase(row_hash.end() - k, row_hash.end());
+            row_hash.insert(row_hash.begin(), k, filled);
+        } else {
+            row_hash.erase(row_hash.begin(), row_hash.begin() + k);
+            row_hash.insert(row_hash.end(), k, filled);
+        }
+        data.shift_vertical_fill(shift_i, filler);
+        recompute_total();
+        return *this;
+    }
+
+    /* ============================
+        Inserting and Deleting
+    ============================= */
+    // Inserts `new_row` as row `position`, as `Array2D::insert_row` (and throwing as it does). Reads only the new row.
+    HashedArray2D& insert_row(const size_t position, std::vector<T> new_row) {
+        const bool was_empty = (size() == 0);
+        data.insert_row(position, std::move(new_row));
+        grow_powers();
+        if (was_empty) {
+            rebuild();
+            return *this;
+        }
+        row_hash.insert(row_hash.begin() + position, row_part(position, 0, colCount()));
+        recompute_total();
+        return *this;
+    }
+
+    HashedArray2D& append_row(std::vector<T> new_row) {
+        return insert_row(rowCount(), std::move(new_row));
+    }
+
+    // Deletes the rows in `[i_start, i_past_end)`, as `Array2D::delete_rows` (and throwing as it does). Reads no elements at all.
+    HashedArray2D& delete_rows(const size_t i_start, const size_t i_past_end) {
+        data.delete_rows(i_start, i_past_end);
+        if (i_start < i_past_end) {
+            row_hash.erase(row_hash.begin() + i_start, row_hash.begin() + i_past_end);
+            recompute_total();
+        }
+        return *this;
+    }
+
+    HashedArray2D& delete_row(const size_t i) {
+        return delete_rows(i, i+1);
+    }
+
+    // Inserts `new_col` as column `position`, as `Array2D::insert_col` (and throwing as it does).
+    // Reads the new column, and in each row the elements on whichever side of it is shorter.
+    HashedArray2D& insert_col(const size_t position, std::vector<T> new_col) {
+        const bool was_empty = (rowCount() == 0);
+        data.insert_col(position, std::move(new_col));
+        grow_powers();
+        if (was_empty) {
+            rebuild();
+            return *this;
+        }
+        // the elements after `position` gain a factor of `BASE_J`
+        const size_t m = colCount();
+        const uint64_t inv_base = hash61::inverse(hash61::BASE_J);
+        for (size_t i=0; i < rowCount(); ++i) {
+            const uint64_t added = hash61::mul(cell_hash(data[i][position]), pow_j[position]);
+            uint64_t before;
+            uint64_t after_moved;
+            if (position <= m - 1 - position) {
+                before = row_part(i, 0, position);
+                after_moved = hash61::mul(hash61::sub(row_hash[i], before), hash61::BASE_J);
+            } else {
+                after_moved = row_part(i, position + 1, m);
+                before = hash61::sub(row_hash[i], hash61::mul(after_moved, inv_base));
+            }
+            row_hash[i] = hash61::add(hash61::add(before, added), after_moved);
+        }
+        recompute_total();
+        return *this;
+    }
+
+    HashedArray2D& append_col(std::vector<T> new_col) {
+        return insert_col(colCount(), std::move(new_col));
+    }
+
+    // Deletes the columns in `[j_start, j_past_end)`, as `Array2D::delete_cols` (and throwing as it does).
+    // Reads the deleted elements, and in each row the elements on whichever side of them is shorter.
+    HashedArray2D& delete_cols(const size_t j_start, const size_t j_past_end) {
+        const size_t m = colCount();
+        if (j_start < m && j_past_end <= m && j_start < j_past_end) {
+            // the elements after the gap lose a factor of `BASE_J^(j_past_end - j_start)`
+            std::vector<uint64_t> fresh(rowCount());
+            const uint64_t factor = hash61::pow(hash61::inverse(hash61::BASE_J), j_past_end - j_start);
+            for (size_t i=0; i < rowCount(); ++i) {
+                const uint64_t gap = row_part(i, j_start, j_past_end);
+                uint64_t before;
+                uint64_t after;
+                if (j_start <= m - j_past_end) {
+                    before = row_part(i, 0, j_start);
+                    after = hash61::sub(hash61::sub(row_hash[i], before), gap);
+                } else {
+                    after = row_part(i, j_past_end, m);
+                    before = hash61::sub(hash61::sub(row_hash[i], after), gap);
+                }
+                fresh[i] = hash61::add(before, hash61::mul(after, factor));
+            }
+            data.delete_cols(j_start, j_past_end);
+            row_hash.swap(fresh);
+            recompute_total();
+        } else {
+            // let `Array2D` report the bad range (or do nothing, for an empty one)
+            data.delete_cols(j_start, j_past_end);
+        }
+        return *this;
+    }
+
+    HashedArray2D& delete_col(const size_t j) {
+        return delete_cols(j, j+1);
+    }
+};
+
+};  // end namespace
+#endif
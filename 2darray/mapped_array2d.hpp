@@ -0,0 +1,452 @@
+#ifndef YELLE_MAPPED_ARRAY2D
+#define YELLE_MAPPED_ARRAY2D
+
+#include "tiled_array2d.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace yelle {
+
+// Access pattern hints passed on to the kernel with `madvise`, so that it knows how far to read ahead and what to evict first.
+enum class access_pattern { NORMAL, SEQUENTIAL, RANDOM };
+
+// Two-dimensional array of `T` stored in a memory-mapped file, for grids larger than RAM: the OS page cache decides which parts are resident.
+// Elements are laid out in `TILE` x `TILE` tiles (as with `tile_layout`), so that each tile covers whole pages whenever `TILE * TILE * sizeof(T)` is a multiple of the page size, and a rectangular region touches as few pages as possible.
+// The file starts with a one-page header recording the dimensions, so it can be reopened later. `T` must be trivially copyable, since its bytes go straight to disk.
+// POSIX only (`mmap`, `madvise`, `msync`).
+template <class T, size_t TILE = 64>
+class MappedArray2D {
+    static_assert(std::is_trivially_copyable<T>::value, "MappedArray2D requires a trivially copyable element type");
+protected:
+    // first bytes of the file; the rest of the first page is unused
+    struct Header {
+        char magic[8];
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t tile;
+        uint64_t elem_size;
+    };
+    static constexpr char MAGIC[8] = {'Y','L','A','2','D','M','A','P'};
+
+    std::string file_path;
+    int fd = -1;
+    unsigned char* base = nullptr;  // start of the mapping (the header)
+    size_t map_bytes = 0;
+    size_t header_bytes = 0;
+    T* data = nullptr;              // start of the tiled elements, one page in
+    tile_layout<TILE> layout;
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+    bool writable = false;
+    access_pattern pattern = access_pattern::NORMAL;
+
+    static size_t page_size() {
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    static int advice_for(const access_pattern hint) {
+        switch (hint) {
+            case access_pattern::SEQUENTIAL:
+                return MADV_SEQUENTIAL;
+            case access_pattern::RANDOM:
+                return MADV_RANDOM;
+            default:
+                return MADV_NORMAL;
+        }
+    }
+
+    // Prints `what` along with `errno`'s description to `stderr`, then throws a `std::runtime_error`.
+    [[noreturn]] static void fail(const char* what, const std::string& path) {
+        fprintf(stderr, "%s '%s': %s\n", what, path.c_str(), strerror(errno));
+        throw std::runtime_error(std::string(what) + " '" + path + "'");
+    }
+
+    // Maps the first `bytes` bytes of the already opened `fd`.
+    void map_file(const size_t bytes, const std::string& path) {
+        map_bytes = bytes;
+        void* mapped = mmap(nullptr, map_bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            fd = -1;
+            fail("Could not memory-map", path);
+        }
+        base = static_cast<unsigned char*>(mapped);
+        data = reinterpret_cast<T*>(base + header_bytes);
+    }
+
+    // Calls `func(i_start, j_start, i_past_end, j_past_end)` on each tile of the array, in file order.
+    template <class Func>
+    void for_each_tile(Func func) const {
+        for (size_t bi=0; bi < row_ct; bi += TILE) {
+            const size_t bi_past_end = std::min(row_ct, bi + TILE);
+            for (size_t bj=0; bj < col_ct; bj += TILE) {
+                func(bi, bj, bi_past_end, std::min(col_ct, bj + TILE));
+            }
+        }
+    }
+
+    // Unmaps and closes the file, if any.
+    void release() noexcept {
+        if (base != nullptr) {
+            munmap(base, map_bytes);
+            base = nullptr;
+            data = nullptr;
+        }
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    // Applies `madvise(hint)` to the element bytes `[offset, offset + length)` for as long as it's alive, then restores the array's own access pattern there.
+    // Operations hint only the bytes they walk, so that e.g. reading one row doesn't change how the rest of the file is read ahead.
+    class HintScope {
+        const MappedArray2D* owner;
+        size_t offset;
+        size_t length;
+    public:
+        HintScope(const MappedArray2D* arr, const size_t first_byte, const size_t byte_ct, const access_pattern hint)
+        : owner(arr), offset(first_byte), length(byte_ct) {
+            owner->advise_range(offset, length, hint);
+        }
+        // Hints all of the elements.
+        HintScope(const MappedArray2D* arr, const access_pattern hint)
+        : HintScope(arr, 0, arr->layout.storage_size() * sizeof(T), hint) {
+        }
+        ~HintScope() {
+            owner->advise_range(offset, length, owner->pattern);
+        }
+    };
+
+    // Byte offset of the band of tiles holding row `i`, within the elements.
+    size_t band_offset(const size_t i) const {
+        return layout.index(i / TILE * TILE, 0) * sizeof(T);
+    }
+
+    // Bytes in one band of tiles.
+    size_t band_bytes() const {
+        return (col_ct + TILE - 1) / TILE * (TILE * TILE) * sizeof(T);
+    }
+
+    // `madvise`s the element bytes `[offset, offset + length)`, widened out to whole pages. Failures are ignored, since the hints are only advisory.
+    void advise_range(const size_t offset, const size_t length, const access_pattern hint) const {
+        advise_bytes(offset, length, advice_for(hint));
+    }
+    void advise_bytes(const size_t offset, const size_t length, const int advice) const {
+        if (base == nullptr || length == 0) {
+            return;
+        }
+        // clamp to the mapping, so that no bad range ever reaches `madvise`
+        if (offset >= map_bytes - header_bytes) {
+            return;
+        }
+        const size_t page = page_size();
+        const size_t first = (header_bytes + offset) / page * page;
+        const size_t last = header_bytes + offset + std::min(length, map_bytes - header_bytes - offset);
+        madvise(base + first, last - first, advice);
+    }
+
+public:
+    // Default constructor: an empty array, not backed by any file.
+    MappedArray2D() {
+        return;
+    }
+
+    // Creates (or truncates) the file at `path` as a `rows` x `cols` array of zero-bytes. The file is sparse, so untouched tiles take no disk space.
+    // Throws a `std::runtime_error` (after printing the reason to `stderr`) if the file cannot be created or mapped.
+    MappedArray2D(const std::string& path, const size_t rows, const size_t cols)
+    : file_path(path), layout(rows, cols), row_ct(rows), col_ct(cols), writable(true) {
+        header_bytes = std::max(page_size(), sizeof(Header));
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            fail("Could not create", path);
+        }
+        const size_t bytes = header_bytes + layout.storage_size() * sizeof(T);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            fd = -1;
+            fail("Could not resize", path);
+        }
+        map_file(bytes, path);
+        Header header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.rows = rows;
+        header.cols = cols;
+        header.tile = TILE;
+        header.elem_size = sizeof(T);
+        memcpy(base, &header, sizeof(Header));
+        return;
+    }
+
+    // Creates (or truncates) the file at `path` as a `rows` x `cols` array of `value`s.
+    MappedArray2D(const std::string& path, const size_t rows, const size_t cols, const T& value)
+    : MappedArray2D(path, rows, cols) {
+        HintScope scope(this, access_pattern::SEQUENTIAL);
+        for_each_tile([this, &value](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    data[layout.index(i, j)] = value;
+                }
+            }
+        });
+        return;
+    }
+
+    // Creates (or truncates) the file at `path` holding a copy of `dense`.
+    MappedArray2D(const std::string& path, const Array2D<T>& dense)
+    : MappedArray2D(path, dense.rowCount(), dense.colCount()) {
+        HintScope scope(this, access_pattern::SEQUENTIAL);
+        for_each_tile([this, &dense](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                const auto& row = dense[i];
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    data[layout.index(i, j)] = row[j];
+                }
+            }
+        });
+        return;
+    }
+
+    // Opens an existing file at `path` that was created by a `MappedArray2D<T,TILE>`, read-only unless `read_write` is set.
+    // Throws a `std::runtime_error` (after printing the reason to `stderr`) if the file cannot be opened or mapped, or was written with a different element size or tile size.
+    explicit MappedArray2D(const std::string& path, const bool read_write = false)
+    : file_path(path), writable(read_write) {
+        header_bytes = std::max(page_size(), sizeof(Header));
+        fd = open(path.c_str(), read_write ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            fail("Could not open", path);
+        }
+        Header header;
+        if (pread(fd, &header, sizeof(Header), 0) != static_cast<ssize_t>(sizeof(Header))
+         || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            close(fd);
+            fd = -1;
+            fprintf(stderr, "'%s' is not a mapped 2D array file!\n", path.c_str());
+            throw std::runtime_error("not a mapped 2D array file");
+        }
+        if (header.tile != TILE || header.elem_size != sizeof(T)) {
+            close(fd);
+            fd = -1;
+            fprintf(stderr, "'%s' holds %zu-byte elements in %zu-wide tiles, not %zu-byte elements in %zu-wide tiles!\n",
+                path.c_str(), static_cast<size_t>(header.elem_size), static_cast<size_t>(header.tile), sizeof(T), TILE);
+            throw std::runtime_error("mapped 2D array file has a different element or tile size");
+        }
+        row_ct = static_cast<size_t>(header.rows);
+        col_ct = static_cast<size_t>(header.cols);
+        layout = tile_layout<TILE>(row_ct, col_ct);
+        const size_t bytes = header_bytes + layout.storage_size() * sizeof(T);
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < bytes) {
+            close(fd);
+            fd = -1;
+            fprintf(stderr, "'%s' is too short for a %zux%zu array!\n", path.c_str(), row_ct, col_ct);
+            throw std::runtime_error("mapped 2D array file is truncated");
+        }
+        map_file(bytes, path);
+        return;
+    }
+
+    MappedArray2D(const MappedArray2D&) = delete;
+    MappedArray2D& operator=(const MappedArray2D&) = delete;
+
+    MappedArray2D(MappedArray2D&& other) noexcept {
+        *this = std::move(other);
+        return;
+    }
+
+    MappedArray2D& operator=(MappedArray2D&& other) noexcept {
+        if (this != &other) {
+            release();
+            file_path = std::move(other.file_path);
+            fd = std::exchange(other.fd, -1);
+            base = std::exchange(other.base, nullptr);
+            data = std::exchange(other.data, nullptr);
+            map_bytes = std::exchange(other.map_bytes, 0);
+            header_bytes = other.header_bytes;
+            layout = other.layout;
+            row_ct = std::exchange(other.row_ct, 0);
+            col_ct = std::exchange(other.col_ct, 0);
+            writable = other.writable;
+            pattern = other.pattern;
+        }
+        return *this;
+    }
+
+    // Unmaps and closes the file. Changes are written back by the OS in its own time; call `flush()` first to be sure they've reached the disk.
+    ~MappedArray2D() {
+        release();
+    }
+
+    /* ============================
+        Attributes & Element Access
+    ============================= */
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+    size_t size() const { return row_ct * col_ct; }
+    bool empty() const { return row_ct == 0 || col_ct == 0; }
+
+    // Direct access to the element at `(i,j)`, without bounds checking. Writing through a read-only mapping will crash.
+    T& operator()(const size_t i, const size_t j) {
+        return data[layout.index(i, j)];
+    }
+    const T& operator()(const size_t i, const size_t j) const {
+        return data[layout.index(i, j)];
+    }
+
+    // Access to the element at `(i,j)`, throwing a `std::out_of_range` if there is no such element.
+    T& at(const size_t i, const size_t j) {
+        if (i >= row_ct || j >= col_ct) {
+            throw std::out_of_range("tried to access nonexistent row or column of mapped array");
+        }
+        return data[layout.index(i, j)];
+    }
+    const T& at(const size_t i, const size_t j) const {
+        if (i >= row_ct || j >= col_ct) {
+            throw std::out_of_range("tried to access nonexistent row or column of mapped array");
+        }
+        return data[layout.index(i, j)];
+    }
+
+    // Returns a `std::optional` copy of the element at `(i,j)`. If there is no element at `(i,j)`, then returns a null optional.
+    std::optional<T> safe_look(const size_t i, const size_t j) const noexcept {
+        if (i >= row_ct || j >= col_ct) {
+            return std::optional<T>();
+        }
+        return std::optional<T>(data[layout.index(i, j)]);
+    }
+
+    /* ============================
+        Residency Control
+    ============================= */
+    // Tells the kernel how the array will be accessed from now on. Whole-array operations switch to `SEQUENTIAL` while they run, and single-row and single-column walks switch the bytes they cover to `RANDOM`, then restore this.
+    MappedArray2D& advise(const access_pattern hint) {
+        pattern = hint;
+        advise_range(0, layout.storage_size() * sizeof(T), hint);
+        return *this;
+    }
+
+    // Asks the kernel to start reading in the tiles covering `[i_start, i_past_end) x [j_start, j_past_end)`, without waiting for them. The region is clipped to the array.
+    // Tiles across a band of the region are adjacent in the file, so this is one `madvise` per band of `TILE` rows.
+    const MappedArray2D& prefetch(const size_t i_start, const size_t j_start, size_t i_past_end, size_t j_past_end) const {
+        i_past_end = std::min(i_past_end, row_ct);
+        j_past_end = std::min(j_past_end, col_ct);
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return *this;
+        }
+        const size_t tile_bytes = TILE * TILE * sizeof(T);
+        for (size_t band=i_start / TILE; band <= (i_past_end - 1) / TILE; ++band) {
+            const size_t first = layout.index(band * TILE, j_start / TILE * TILE) * sizeof(T);
+            const size_t last = layout.index(band * TILE, (j_past_end - 1) / TILE * TILE) * sizeof(T) + tile_bytes;
+            advise_bytes(first, last - first, MADV_WILLNEED);
+        }
+        return *this;
+    }
+
+    // Writes all modified pages back to the file. With `wait=false`, only schedules the write-back (`MS_ASYNC`) instead of blocking until it's done.
+    // Throws a `std::runtime_error` (after printing the reason to `stderr`) if `msync` fails.
+    MappedArray2D& flush(const bool wait = true) {
+        if (base != nullptr && writable) {
+            if (msync(base, map_bytes, wait ? MS_SYNC : MS_ASYNC) != 0) {
+                fail("Could not flush", file_path);
+            }
+        }
+        return *this;
+    }
+
+    /* ============================
+        Calculations
+    ============================= */
+    // Map a unary function of type `T -> T` onto this array, changing each value in-place. Walks the file front to back, tile by tile.
+    MappedArray2D& map_inplace(const std::function<T(T)>& func) {
+        HintScope scope(this, access_pattern::SEQUENTIAL);
+        for_each_tile([this, &func](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    T& elem = data[layout.index(i, j)];
+                    elem = func(elem);
+                }
+            }
+        });
+        return *this;
+    }
+
+    // Folds `func` over every element, walking the file front to back. The order in which elements are visited is unspecified, so `func` should be associative and commutative (like `+` or `max`).
+    template <class S>
+    S reduce(const std::function<S(S,T)>& func, S accumulator) const {
+        HintScope scope(this, access_pattern::SEQUENTIAL);
+        for_each_tile([this, &func, &accumulator](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    accumulator = func(accumulator, data[layout.index(i, j)]);
+                }
+            }
+        });
+        return accumulator;
+    }
+
+    // Sums all elements in the array. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum() const {
+        std::plus<T> T_addition;
+        return reduce<T>(T_addition, T());
+    }
+
+    // Sums all elements in row `row_i`, which lie in one band of tiles. Only a `TILE`-wide sliver of each tile is read, so read-ahead would mostly fetch the rest of the tile for nothing; the band alone is hinted as `RANDOM`.
+    T sum_row(const size_t row_i) const {
+        if (row_i >= row_ct) {
+            throw std::out_of_range("cannot use sum_row on too high of row index");
+        }
+        HintScope scope(this, band_offset(row_i), band_bytes(), access_pattern::RANDOM);
+        T total = T();
+        for (size_t j=0; j < col_ct; ++j) {
+            total = total + data[layout.index(row_i, j)];
+        }
+        return total;
+    }
+
+    // Sums all elements in column `column_j`, which lie in one tile of each band; read-ahead wouldn't help, so the walk is hinted as `RANDOM`.
+    T sum_col(const size_t column_j) const {
+        if (column_j >= col_ct) {
+            throw std::out_of_range("cannot use sum_col on too high of column index");
+        }
+        if (row_ct == 0) {
+            return T();
+        }
+        const size_t first = layout.index(0, column_j) * sizeof(T);
+        const size_t last = (layout.index(row_ct - 1, column_j) + 1) * sizeof(T);
+        HintScope scope(this, first, last - first, access_pattern::RANDOM);
+        T total = T();
+        for (size_t i=0; i < row_ct; ++i) {
+            total = total + data[layout.index(i, column_j)];
+        }
+        return total;
+    }
+
+    /* ============================
+        Conversion
+    ============================= */
+    // Copies the contents out into an in-memory `Array2D`. Only sensible for arrays that fit in RAM.
+    Array2D<T> to_array() const {
+        HintScope scope(this, access_pattern::SEQUENTIAL);
+        std::vector<std::vector<T>> rows(row_ct, std::vector<T>(col_ct));
+        for_each_tile([this, &rows](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    rows[i][j] = data[layout.index(i, j)];
+                }
+            }
+        });
+        return Array2D<T>(std::move(rows));
+    }
+};
+
+};  // end namespace
+#endif
@@ -0,0 +1,515 @@
+#ifndef YELLE_PATHFIND2D
+#define YELLE_PATHFIND2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+namespace yelle {
+
+// A path found by `PathFinder2D`.
+template <class Cost>
+struct GridPath {
+    // Total cost of the cells stepped onto (not counting the first), or the number of steps for `bfs`.
+    Cost cost = Cost();
+    // Positions `{i,j}` along the path, from the source to the target inclusive; empty if there is no path.
+    std::vector<std::pair<size_t, size_t>> cells;
+
+    bool found() const { return !cells.empty(); }
+};
+
+// One query for `PathFinder2D::batch`.
+struct PathQuery {
+    size_t from_i;
+    size_t from_j;
+    size_t to_i;
+    size_t to_j;
+};
+
+// Shortest-path engine over a grid, treated as a 4- or 8-connected graph where stepping onto a cell costs that cell's cost.
+// `load` copies the grid's costs once into a flat array with an impassable one-cell border, so that queries walk neighbours by index offset without any bounds checks.
+// The distance, parent, and visited arrays are kept between queries and never cleared: each query stamps the cells it touches, so a query that stops early costs only what it visited.
+// With integer costs of at most `max_bucket_cost`, Dijkstra and A* pop cells from a bucket queue (Dial's algorithm) instead of a binary heap.
+// Queries change the scratch buffers, so one `PathFinder2D` can only run one query at a time; `batch` runs many at once, each thread with scratch buffers of its own.
+template <class Cost = uint32_t>
+class PathFinder2D {
+public:
+    static_assert(std::is_arithmetic<Cost>::value, "path costs must be arithmetic");
+    // Cost of an impassable cell, and the distance to an unreachable one.
+    static constexpr Cost IMPASSABLE = std::numeric_limits<Cost>::max();
+    // Largest integer cell cost for which the bucket queue is used.
+    static constexpr size_t max_bucket_cost = 4096;
+
+protected:
+    // Marks a cell with no parent (a source) or no target.
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Step from a cell to one of its neighbours: `offset` in the padded flat array, and `di`,`dj` in the grid.
+    struct Step {
+        long offset;
+        long di;
+        long dj;
+    };
+
+    // Priority queue of cells for one query.
+    // `bucket` holds cells by priority modulo its size (a power of two), which must exceed the largest gap between the priorities queued at once; otherwise `heap` is a min-heap.
+    struct Queue {
+        std::vector<std::vector<uint32_t>> bucket;
+        std::vector<std::pair<Cost, uint32_t>> heap;
+        size_t pending = 0;
+        size_t cursor = SIZE_MAX;       // lowest priority that may still be queued
+    };
+
+public:
+    // What a query knows about one cell. Kept together, so that visiting a cell touches one cache line rather than one per field.
+    // `dist` and `parent` are only meaningful if `stamp` is at least the query's `open_mark`; the cell has been settled if `stamp` equals its `closed_mark`.
+    struct Node {
+        Cost dist;
+        uint32_t parent;
+        uint32_t stamp;
+    };
+
+    // Per-query working storage, reused from one query to the next.
+    struct Scratch {
+        std::vector<Node> node;
+        uint32_t open_mark = 0;
+        uint32_t closed_mark = 0;
+        std::vector<uint32_t> fifo;
+        Queue queue;
+    };
+
+protected:
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+    size_t stride = 2;                  // `col_ct` plus the border on either side
+    connectivity conn = connectivity::FOUR;
+    std::vector<Cost> cell_cost;        // cost of stepping onto each cell, in the padded flat layout
+    Cost min_cost = Cost();             // smallest passable cost, which scales the A* heuristic
+    Cost max_cost = Cost();             // largest passable cost
+    bool use_buckets = false;
+    std::vector<Step> steps;
+    Scratch scratch;
+    std::vector<Scratch> batch_scratch;
+
+    // Index in the padded flat layout of grid cell `[i,j]`.
+    uint32_t flat(const size_t i, const size_t j) const {
+        return static_cast<uint32_t>((i+1) * stride + (j+1));
+    }
+
+    std::pair<size_t, size_t> position(const uint32_t k) const {
+        return {k / stride - 1, k % stride - 1};
+    }
+
+    // Flat index of `[i,j]`, which must be in range.
+    uint32_t checked_flat(const size_t i, const size_t j) const {
+        if (i >= row_ct || j >= col_ct) {
+            fprintf(stderr, "Position [%zu,%zu] is outside the %zu x %zu grid!\n", i, j, row_ct, col_ct);
+            throw std::out_of_range("position outside the grid");
+        }
+        return flat(i, j);
+    }
+
+    // Readies `s` for a new query: sizes it to the grid, and advances its stamps so that every cell counts as unvisited.
+    void begin_query(Scratch& s) const {
+        if (s.node.size() != cell_cost.size() || s.closed_mark >= UINT32_MAX - 2) {
+            s.node.assign(cell_cost.size(), Node{IMPASSABLE, NONE, 0});
+            s.closed_mark = 0;
+        }
+        s.open_mark = s.closed_mark + 1;
+        s.closed_mark = s.open_mark + 1;
+    }
+
+    // A* heuristic: a lower bound on the cost from `[i,j]` to `[ti,tj]`, given that every step costs at least `min_cost`.
+    Cost estimate(const long i, const long j, const long ti, const long tj) const {
+        const long di = std::abs(i - ti);
+        const long dj = std::abs(j - tj);
+        const long hops = (conn == connectivity::FOUR) ? di + dj : std::max(di, dj);
+        return static_cast<Cost>(hops) * min_cost;
+    }
+
+    void queue_reset(Queue& q) const {
+        if (use_buckets) {
+            for (std::vector<uint32_t>& b : q.bucket) {
+                b.clear();
+            }
+            // an A* step raises the priority by at most the cell's cost plus `min_cost`
+            size_t width = 1;
+            while (width <= 2 * static_cast<size_t>(max_cost)) {
+                width *= 2;
+            }
+            q.bucket.resize(width);
+        } else {
+            q.heap.clear();
+        }
+        q.pending = 0;
+        q.cursor = SIZE_MAX;
+    }
+
+    void queue_push(Queue& q, const Cost key, const uint32_t k) const {
+        if (use_buckets) {
+            // priorities never fall below the last one popped, so the cursor only moves back for the sources
+            const size_t slot = static_cast<size_t>(key);
+            q.cursor = std::min(q.cursor, slot);
+            ++q.pending;
+            q.bucket[slot & (q.bucket.size() - 1)].push_back(k);
+        } else {
+            q.heap.emplace_back(key, k);
+            std::push_heap(q.heap.begin(), q.heap.end(), std::greater<std::pair<Cost, uint32_t>>());
+        }
+    }
+
+    // Pops a cell of least priority into `k`, returning `false` if the queue is empty.
+    bool queue_pop(Queue& q, uint32_t& k) const {
+        if (use_buckets) {
+            if (q.pending == 0) {
+                return false;
+            }
+            const size_t mask = q.bucket.size() - 1;
+            while (q.bucket[q.cursor & mask].empty()) {
+                ++q.cursor;
+            }
+            std::vector<uint32_t>& b = q.bucket[q.cursor & mask];
+            k = b.back();
+            b.pop_back();
+            --q.pending;
+            return true;
+        }
+        if (q.heap.empty()) {
+            return false;
+        }
+        std::pop_heap(q.heap.begin(), q.heap.end(), std::greater<std::pair<Cost, uint32_t>>());
+        k = q.heap.back().second;
+        q.heap.pop_back();
+        return true;
+    }
+
+    // Dijkstra (if `GUIDED` is `false`) or A* towards `target` (if `true`) from every cell in `sources` at once, stopping once `target` is settled.
+    // With `target == NONE`, settles every reachable cell instead. Returns whether `target` was reached.
+    template <bool GUIDED>
+    bool search(Scratch& s, const std::vector<uint32_t>& sources, const uint32_t target) const {
+        begin_query(s);
+        Queue& q = s.queue;
+        queue_reset(q);
+        long ti = 0;
+        long tj = 0;
+        if (GUIDED) {
+            const std::pair<size_t, size_t> t = position(target);
+            ti = static_cast<long>(t.first);
+            tj = static_cast<long>(t.second);
+        }
+        const Cost* cost = cell_cost.data();
+        Node* node = s.node.data();
+        const uint32_t open_mark = s.open_mark;
+        const uint32_t closed_mark = s.closed_mark;
+
+        for (const uint32_t k : sources) {
+            if (cost[k] == IMPASSABLE || node[k].stamp >= open_mark) {
+                continue;
+            }
+            node[k].stamp = open_mark;
+            node[k].dist = Cost();
+            node[k].parent = NONE;
+            Cost key = Cost();
+            if (GUIDED) {
+                const std::pair<size_t, size_t> p = position(k);
+                key = estimate(static_cast<long>(p.first), static_cast<long>(p.second), ti, tj);
+            }
+            queue_push(q, key, k);
+        }
+
+        uint32_t k;
+        while (queue_pop(q, k)) {
+            // a cell is queued again whenever a shorter way to it is found; only its first pop counts
+            if (node[k].stamp == closed_mark) {
+                continue;
+            }
+            node[k].stamp = closed_mark;
+            if (k == target) {
+                return true;
+            }
+            const Cost here = node[k].dist;
+            long i = 0;
+            long j = 0;
+            if (GUIDED) {
+                const std::pair<size_t, size_t> p = position(k);
+                i = static_cast<long>(p.first);
+                j = static_cast<long>(p.second);
+            }
+            for (const Step& step : steps) {
+                const uint32_t n = static_cast<uint32_t>(static_cast<long>(k) + step.offset);
+                const Cost c = cost[n];
+                if (c == IMPASSABLE || node[n].stamp == closed_mark) {
+                    continue;
+                }
+                const Cost through = here + c;
+                if (node[n].stamp < open_mark || through < node[n].dist) {
+                    node[n].stamp = open_mark;
+                    node[n].dist = through;
+                    node[n].parent = k;
+                    const Cost key = GUIDED ? through + estimate(i + step.di, j + step.dj, ti, tj) : through;
+                    queue_push(q, key, n);
+                }
+            }
+        }
+        return false;
+    }
+
+    // Breadth-first search from every cell in `sources` at once, counting steps and ignoring costs (other than `IMPASSABLE`), stopping once `target` is found.
+    // With `target == NONE`, visits every reachable cell instead. Returns whether `target` was reached.
+    bool search_steps(Scratch& s, const std::vector<uint32_t>& sources, const uint32_t target) const {
+        begin_query(s);
+        const Cost* cost = cell_cost.data();
+        Node* node = s.node.data();
+        const uint32_t closed_mark = s.closed_mark;
+        std::vector<uint32_t>& fifo = s.fifo;
+        fifo.clear();
+
+        // every step costs the same, so a cell's first discovery is by a shortest path, and it's settled right away
+        for (const uint32_t k : sources) {
+            if (cost[k] == IMPASSABLE || node[k].stamp == closed_mark) {
+                continue;
+            }
+            node[k].stamp = closed_mark;
+            node[k].dist = Cost();
+            node[k].parent = NONE;
+            fifo.push_back(k);
+        }
+        for (size_t head=0; head < fifo.size(); ++head) {
+            const uint32_t k = fifo[head];
+            if (k == target) {
+                return true;
+            }
+            const Cost next = node[k].dist + 1;
+            for (const Step& step : steps) {
+                const uint32_t n = static_cast<uint32_t>(static_cast<long>(k) + step.offset);
+                if (cost[n] == IMPASSABLE || node[n].stamp == closed_mark) {
+                    continue;
+                }
+                node[n].stamp = closed_mark;
+                node[n].dist = next;
+                node[n].parent = k;
+                fifo.push_back(n);
+            }
+        }
+        return false;
+    }
+
+    // Follows the parents back from `target` after a successful search.
+    GridPath<Cost> trace(const Scratch& s, const uint32_t target) const {
+        GridPath<Cost> path;
+        path.cost = s.node[target].dist;
+        for (uint32_t k=target; k != NONE; k = s.node[k].parent) {
+            path.cells.push_back(position(k));
+        }
+        std::reverse(path.cells.begin(), path.cells.end());
+        return path;
+    }
+
+    // Runs a single query from `[from_i,from_j]` to `[to_i,to_j]` on `s`.
+    template <bool GUIDED>
+    GridPath<Cost> query(Scratch& s, const size_t from_i, const size_t from_j, const size_t to_i, const size_t to_j) const {
+        const std::vector<uint32_t> sources{checked_flat(from_i, from_j)};
+        const uint32_t target = checked_flat(to_i, to_j);
+        if (search<GUIDED>(s, sources, target)) {
+            return trace(s, target);
+        }
+        return GridPath<Cost>();
+    }
+
+    std::vector<uint32_t> flat_sources(const std::vector<std::pair<size_t, size_t>>& sources) const {
+        std::vector<uint32_t> flat_list;
+        flat_list.reserve(sources.size());
+        for (const std::pair<size_t, size_t>& p : sources) {
+            flat_list.push_back(checked_flat(p.first, p.second));
+        }
+        return flat_list;
+    }
+
+    // Copies the distances of the last search on `s` out into an `Array2D`, with `IMPASSABLE` for cells it didn't reach.
+    Array2D<Cost> distance_array(const Scratch& s) const {
+        std::vector<std::vector<Cost>> rows(row_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            rows[i].resize(col_ct);
+            const uint32_t base = flat(i, 0);
+            for (size_t j=0; j < col_ct; ++j) {
+                const Node& n = s.node[base + j];
+                rows[i][j] = (n.stamp >= s.open_mark) ? n.dist : IMPASSABLE;
+            }
+        }
+        return Array2D<Cost>(std::move(rows));
+    }
+
+public:
+    // Default constructor: an empty grid.
+    PathFinder2D() {
+        return;
+    }
+
+    // Loads the costs of `grid`; see `load`.
+    template <class T, class CostFunc>
+    PathFinder2D(const Array2D<T>& grid, CostFunc cost_of, const connectivity connect = connectivity::FOUR) {
+        load(grid, cost_of, connect);
+        return;
+    }
+
+    // Sets up the graph of `grid`, replacing any previous one, where neighbouring cells are joined by 4- or 8-connectivity.
+    // `cost_of(cell)` gives the cost of stepping onto a cell, or `IMPASSABLE` if it can't be entered; if it returns a `bool` instead, it says whether the cell is passable, and every passable cell costs `1`.
+    // Diagonal steps cost the same as straight ones. Costs must not be negative, and a path's total cost must fit in `Cost`.
+    // Throws a `std::invalid_argument` for a negative cost, or a `std::length_error` if the grid has too many cells for 32-bit indices.
+    template <class T, class CostFunc>
+    PathFinder2D& load(const Array2D<T>& grid, CostFunc cost_of, const connectivity connect = connectivity::FOUR) {
+        constexpr bool PASSABILITY = std::is_same<typename std::decay<decltype(cost_of(std::declval<const T&>()))>::type, bool>::value;
+        row_ct = grid.rowCount();
+        col_ct = grid.colCount();
+        stride = col_ct + 2;
+        conn = connect;
+        if ((row_ct + 2) * stride >= NONE) {
+            fprintf(stderr, "Cannot search a %zu x %zu grid: it has too many cells for 32-bit indices!\n", row_ct, col_ct);
+            throw std::length_error("grid too large to search");
+        }
+        cell_cost.assign((row_ct + 2) * stride, IMPASSABLE);
+        min_cost = IMPASSABLE;
+        max_cost = Cost();
+        for (size_t i=0; i < row_ct; ++i) {
+            const auto row = grid[i];
+            Cost* out = cell_cost.data() + flat(i, 0);
+            for (size_t j=0; j < col_ct; ++j) {
+                Cost c;
+                if constexpr (PASSABILITY) {
+                    c = cost_of(row[j]) ? Cost(1) : IMPASSABLE;
+                } else {
+                    c = static_cast<Cost>(cost_of(row[j]));
+                }
+                if constexpr (std::is_signed<Cost>::value) {
+                    if (c < Cost()) {
+                        fprintf(stderr, "Cell [%zu,%zu] has a negative cost!\n", i, j);
+                        throw std::invalid_argument("negative cell cost");
+                    }
+                }
+                out[j] = c;
+                if (c != IMPASSABLE) {
+                    min_cost = std::min(min_cost, c);
+                    max_cost = std::max(max_cost, c);
+                }
+            }
+        }
+        if (min_cost == IMPASSABLE) {
+            min_cost = Cost();
+        }
+        use_buckets = std::is_integral<Cost>::value && static_cast<size_t>(max_cost) <= max_bucket_cost;
+
+        const long s = static_cast<long>(stride);
+        steps = {{-s, -1, 0}, {-1, 0, -1}, {1, 0, 1}, {s, 1, 0}};
+        if (conn == connectivity::EIGHT) {
+            steps.insert(steps.end(), {{-s-1, -1, -1}, {-s+1, -1, 1}, {s-1, 1, -1}, {s+1, 1, 1}});
+        }
+        return *this;
+    }
+
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+
+    // Cost of stepping onto `[i,j]`, as loaded, without bounds checking.
+    Cost cost(const size_t i, const size_t j) const {
+        return cell_cost[flat(i, j)];
+    }
+
+    /* ============================
+        Single Queries
+    ============================= */
+    // Path with the fewest steps from `[from_i,from_j]` to `[to_i,to_j]`, ignoring cell costs (other than `IMPASSABLE`), by breadth-first search.
+    // Returns an empty path if there is none. Throws a `std::out_of_range` if either position is outside the grid.
+    GridPath<Cost> bfs(const size_t from_i, const size_t from_j, const size_t to_i, const size_t to_j) {
+        const std::vector<uint32_t> sources{checked_flat(from_i, from_j)};
+        const uint32_t target = checked_flat(to_i, to_j);
+        if (search_steps(scratch, sources, target)) {
+            return trace(scratch, target);
+        }
+        return GridPath<Cost>();
+    }
+
+    // Cheapest path from `[from_i,from_j]` to `[to_i,to_j]`, by Dijkstra's algorithm.
+    // Returns an empty path if there is none. Throws a `std::out_of_range` if either position is outside the grid.
+    GridPath<Cost> dijkstra(const size_t from_i, const size_t from_j, const size_t to_i, const size_t to_j) {
+        return query<false>(scratch, from_i, from_j, to_i, to_j);
+    }
+
+    // Cheapest path from `[from_i,from_j]` to `[to_i,to_j]`, by A* search guided by the Manhattan (4-connected) or Chebyshev (8-connected) distance times the smallest cell cost.
+    // Finds a path of the same cost as `dijkstra`, usually after visiting far fewer cells.
+    // Returns an empty path if there is none. Throws a `std::out_of_range` if either position is outside the grid.
+    GridPath<Cost> astar(const size_t from_i, const size_t from_j, const size_t to_i, const size_t to_j) {
+        return query<true>(scratch, from_i, from_j, to_i, to_j);
+    }
+
+    /* ============================
+        Many Sources
+    ============================= */
+    // Cost of the cheapest path to every cell from whichever of `sources` is nearest, in one pass of Dijkstra's algorithm; `IMPASSABLE` for cells that none of them reach.
+    // Throws a `std::out_of_range` if any source is outside the grid.
+    Array2D<Cost> distances_from(const std::vector<std::pair<size_t, size_t>>& sources) {
+        search<false>(scratch, flat_sources(sources), NONE);
+        return distance_array(scratch);
+    }
+
+    // Fewest steps to every cell from whichever of `sources` is nearest, in one breadth-first pass ignoring cell costs; `IMPASSABLE` for cells that none of them reach.
+    // Throws a `std::out_of_range` if any source is outside the grid.
+    Array2D<Cost> steps_from(const std::vector<std::pair<size_t, size_t>>& sources) {
+        search_steps(scratch, flat_sources(sources), NONE);
+        return distance_array(scratch);
+    }
+
+    // Cheapest path to `[to_i,to_j]` from whichever of `sources` is nearest, by Dijkstra's algorithm.
+    // Returns an empty path if there is none. Throws a `std::out_of_range` if any position is outside the grid.
+    GridPath<Cost> nearest(const std::vector<std::pair<size_t, size_t>>& sources, const size_t to_i, const size_t to_j) {
+        const uint32_t target = checked_flat(to_i, to_j);
+        if (search<false>(scratch, flat_sources(sources), target)) {
+            return trace(scratch, target);
+        }
+        return GridPath<Cost>();
+    }
+
+    // Answers every query by `astar`, splitting them across up to `threads` threads (`0` for the hardware's concurrency), each with scratch buffers of its own that are kept for the next batch.
+    // `result[q]` is the path for `queries[q]`. Throws a `std::out_of_range` if any position is outside the grid, before any query is run.
+    std::vector<GridPath<Cost>> batch(const std::vector<PathQuery>& queries, size_t threads = 0) {
+        for (const PathQuery& q : queries) {
+            checked_flat(q.from_i, q.from_j);
+            checked_flat(q.to_i, q.to_j);
+        }
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        threads = std::max<size_t>(1, std::min(threads, queries.size()));
+        if (batch_scratch.size() < threads) {
+            batch_scratch.resize(threads);
+        }
+
+        std::vector<GridPath<Cost>> result(queries.size());
+        // queries can differ wildly in cost, so threads take them one at a time rather than in fixed shares
+        std::atomic<size_t> next{0};
+        const auto work = [&](Scratch& s) {
+            for (size_t q = next.fetch_add(1, std::memory_order_relaxed); q < queries.size(); q = next.fetch_add(1, std::memory_order_relaxed)) {
+                result[q] = query<true>(s, queries[q].from_i, queries[q].from_j, queries[q].to_i, queries[q].to_j);
+            }
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (size_t t=1; t < threads; ++t) {
+            pool.emplace_back(work, std::ref(batch_scratch[t]));
+        }
+        work(batch_scratch[0]);
+        for (std::thread& t : pool) {
+            t.join();
+        }
+        return result;
+    }
+};
+
+};  // end namespace
+#endif
@@ -0,0 +1,290 @@
+#ifndef YELLE_SLIDING_WINDOW
+#define YELLE_SLIDING_WINDOW
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+namespace yelle {
+
+// Direction that a 1D window slides in: `HORIZONTAL` windows run along each row, `VERTICAL` windows run down each column.
+enum class window_axis { HORIZONTAL, VERTICAL };
+
+// Sliding-window min, max, and sum over an `Array2D<T>`, in O(1) work per output cell regardless of window size.
+// Windows are "valid"-mode: a width-`k` horizontal window over a `R x C` array gives a `R x (C-k+1)` result, whose `[i,j]` is taken over `[i, j..j+k-1]`; vertical windows and `kh x kw` rectangles work likewise.
+// Min and max use the van Herk/Gil-Werman algorithm; sums use running totals.
+// Results are written into a caller-supplied `out` array, which is only reallocated if it isn't already the right shape; the scratch buffers are kept between calls too, so repeated calls through one `SlidingWindow` don't allocate.
+template <class T>
+class SlidingWindow {
+protected:
+    std::vector<T> suffix;  // per-block suffix extrema, from the right edge of each block of `k`
+    std::vector<T> prefix;  // running per-block prefix extrema, from the left edge of each block of `k`
+    Array2D<T> pass;        // intermediate result between the horizontal and vertical passes of a 2D window
+
+    // Throws a `std::length_error` unless `1 <= k <= length`.
+    static void check_window(const size_t k, const size_t length, const char* direction) {
+        if (k == 0 || k > length) {
+            fprintf(stderr, "Tried to slide a window of %zu cells %s across only %zu cells!\n", k, direction, length);
+            throw std::length_error("window size must be between 1 and the array's extent");
+        }
+    }
+
+    // Makes `out` a `row_ct` x `col_ct` array, keeping its storage if it already has that shape.
+    template <class S>
+    static void shape_output(Array2D<S>& out, const size_t row_ct, const size_t col_ct) {
+        if (out.rowCount() != row_ct || out.colCount() != col_ct) {
+            out.fill(row_ct, col_ct, S());
+        }
+    }
+
+    // van Herk/Gil-Werman along each row: `better(a,b)` is `true` when `a` should win over `b`.
+    template <class Better>
+    void extremum_horizontal(const Array2D<T>& in, Array2D<T>& out, const size_t k, Better better) {
+        const size_t row_ct = in.rowCount();
+        const size_t col_ct = in.colCount();
+        check_window(k, col_ct, "horizontally");
+        shape_output(out, row_ct, col_ct - k + 1);
+        suffix.resize(col_ct);
+
+        for (size_t i=0; i < row_ct; ++i) {
+            const auto& src = in[i];
+            auto&& dst = out[i];
+            // right-to-left within each block of `k`
+            for (size_t x=col_ct; x-- > 0; ) {
+                const bool block_end = ((x+1) % k == 0) || (x+1 == col_ct);
+                suffix[x] = (block_end || better(src[x], suffix[x+1])) ? src[x] : suffix[x+1];
+            }
+            // left-to-right within each block, combining with the suffix of the window's first cell
+            T running = src[0];
+            for (size_t x=0; x < col_ct; ++x) {
+                if (x % k == 0 || better(src[x], running)) {
+                    running = src[x];
+                }
+                if (x + 1 >= k) {
+                    const T& left = suffix[x+1-k];
+                    dst[x+1-k] = better(left, running) ? left : running;
+                }
+            }
+        }
+    }
+
+    // van Herk/Gil-Werman down each column, processed a whole row at a time so that every pass is a contiguous sweep.
+    template <class Better>
+    void extremum_vertical(const Array2D<T>& in, Array2D<T>& out, const size_t k, Better better) {
+        const size_t row_ct = in.rowCount();
+        const size_t col_ct = in.colCount();
+        check_window(k, row_ct, "vertically");
+        shape_output(out, row_ct - k + 1, col_ct);
+        suffix.resize(row_ct * col_ct);
+        prefix.resize(col_ct);
+
+        // bottom-to-top within each block of `k` rows
+        for (size_t y=row_ct; y-- > 0; ) {
+            const auto& src = in[y];
+            T* suf = suffix.data() + y*col_ct;
+            const bool block_end = ((y+1) % k == 0) || (y+1 == row_ct);
+            if (block_end) {
+                for (size_t j=0; j < col_ct; ++j) {
+                    suf[j] = src[j];
+                }
+            } else {
+                const T* below = suf + col_ct;
+                for (size_t j=0; j < col_ct; ++j) {
+                    suf[j] = better(src[j], below[j]) ? src[j] : below[j];
+                }
+            }
+        }
+        // top-to-bottom within each block, combining with the suffix of the window's first row
+        for (size_t y=0; y < row_ct; ++y) {
+            const auto& src = in[y];
+            if (y % k == 0) {
+                for (size_t j=0; j < col_ct; ++j) {
+                    prefix[j] = src[j];
+                }
+            } else {
+                for (size_t j=0; j < col_ct; ++j) {
+                    if (better(src[j], prefix[j])) {
+                        prefix[j] = src[j];
+                    }
+                }
+            }
+            if (y + 1 >= k) {
+                auto&& dst = out[y+1-k];
+                const T* top = suffix.data() + (y+1-k)*col_ct;
+                for (size_t j=0; j < col_ct; ++j) {
+                    dst[j] = better(top[j], prefix[j]) ? top[j] : prefix[j];
+                }
+            }
+        }
+    }
+
+    template <class Better>
+    void extremum(const Array2D<T>& in, Array2D<T>& out, const size_t k, const window_axis axis, Better better) {
+        if (axis == window_axis::HORIZONTAL) {
+            extremum_horizontal(in, out, k, better);
+        } else {
+            extremum_vertical(in, out, k, better);
+        }
+    }
+
+public:
+    /* ============================
+        1D Windows
+    ============================= */
+    // Writes the minimum of every width-`k` window along `axis` into `out`. Requires `operator<` on `T`.
+    // Will throw a `std::length_error` if `k` is 0 or longer than the array along `axis`.
+    Array2D<T>& min(const Array2D<T>& in, Array2D<T>& out, const size_t k, const window_axis axis) {
+        extremum(in, out, k, axis, [](const T& a, const T& b) { return a < b; });
+        return out;
+    }
+
+    // Writes the maximum of every width-`k` window along `axis` into `out`. Requires `operator<` on `T`.
+    // Will throw a `std::length_error` if `k` is 0 or longer than the array along `axis`.
+    Array2D<T>& max(const Array2D<T>& in, Array2D<T>& out, const size_t k, const window_axis axis) {
+        extremum(in, out, k, axis, [](const T& a, const T& b) { return b < a; });
+        return out;
+    }
+
+    // Writes the sum of every width-`k` window along `axis` into `out`, accumulated in type `S`. Requires `S + S -> S`, `S - S -> S`, and that `S()` be the additive identity.
+    // Will throw a `std::length_error` if `k` is 0 or longer than the array along `axis`.
+    template <class S = T>
+    Array2D<S>& sum(const Array2D<T>& in, Array2D<S>& out, const size_t k, const window_axis axis) const {
+        const size_t row_ct = in.rowCount();
+        const size_t col_ct = in.colCount();
+        if (axis == window_axis::HORIZONTAL) {
+            check_window(k, col_ct, "horizontally");
+            shape_output(out, row_ct, col_ct - k + 1);
+            for (size_t i=0; i < row_ct; ++i) {
+                const auto& src = in[i];
+                auto&& dst = out[i];
+                S running = S();
+                for (size_t x=0; x < k; ++x) {
+                    running = running + static_cast<S>(src[x]);
+                }
+                dst[0] = running;
+                for (size_t x=k; x < col_ct; ++x) {
+                    running = running + static_cast<S>(src[x]) - static_cast<S>(src[x-k]);
+                    dst[x+1-k] = running;
+                }
+            }
+        } else {
+            check_window(k, row_ct, "vertically");
+            shape_output(out, row_ct - k + 1, col_ct);
+            // the first output row is built up in-place, and each later one derived from the row above it
+            {
+                auto&& dst = out[0];
+                for (size_t j=0; j < col_ct; ++j) {
+                    dst[j] = S();
+                }
+                for (size_t y=0; y < k; ++y) {
+                    const auto& src = in[y];
+                    for (size_t j=0; j < col_ct; ++j) {
+                        dst[j] = dst[j] + static_cast<S>(src[j]);
+                    }
+                }
+            }
+            for (size_t y=k; y < row_ct; ++y) {
+                const auto& entering = in[y];
+                const auto& leaving = in[y-k];
+                const auto& above = out[y-k];
+                auto&& dst = out[y+1-k];
+                for (size_t j=0; j < col_ct; ++j) {
+                    dst[j] = above[j] + static_cast<S>(entering[j]) - static_cast<S>(leaving[j]);
+                }
+            }
+        }
+        return out;
+    }
+
+    /* ============================
+        2D (Rectangular) Windows
+            Computed separably: a horizontal pass of width `kw`, then a vertical pass of height `kh`.
+    ============================= */
+    // Writes the minimum of every `kh` x `kw` window into `out`, which becomes `(R-kh+1) x (C-kw+1)`.
+    Array2D<T>& min(const Array2D<T>& in, Array2D<T>& out, const size_t kh, const size_t kw) {
+        min(in, pass, kw, window_axis::HORIZONTAL);
+        return min(pass, out, kh, window_axis::VERTICAL);
+    }
+
+    // Writes the maximum of every `kh` x `kw` window into `out`, which becomes `(R-kh+1) x (C-kw+1)`.
+    Array2D<T>& max(const Array2D<T>& in, Array2D<T>& out, const size_t kh, const size_t kw) {
+        max(in, pass, kw, window_axis::HORIZONTAL);
+        return max(pass, out, kh, window_axis::VERTICAL);
+    }
+
+    // Writes the sum of every `kh` x `kw` window into `out`, which becomes `(R-kh+1) x (C-kw+1)`.
+    // Done in a single sweep: running vertical sums over the last `kh` rows are kept per column, and slid across horizontally for each output row.
+    template <class S = T>
+    Array2D<S>& sum(const Array2D<T>& in, Array2D<S>& out, const size_t kh, const size_t kw) const {
+        const size_t row_ct = in.rowCount();
+        const size_t col_ct = in.colCount();
+        check_window(kh, row_ct, "vertically");
+        check_window(kw, col_ct, "horizontally");
+        shape_output(out, row_ct - kh + 1, col_ct - kw + 1);
+
+        std::vector<S> column_sums(col_ct, S());
+        for (size_t y=0; y < row_ct; ++y) {
+            const auto& entering = in[y];
+            for (size_t j=0; j < col_ct; ++j) {
+                column_sums[j] = column_sums[j] + static_cast<S>(entering[j]);
+            }
+            if (y >= kh) {
+                const auto& leaving = in[y-kh];
+                for (size_t j=0; j < col_ct; ++j) {
+                    column_sums[j] = column_sums[j] - static_cast<S>(leaving[j]);
+                }
+            }
+            if (y + 1 >= kh) {
+                auto&& dst = out[y+1-kh];
+                S running = S();
+                for (size_t x=0; x < kw; ++x) {
+                    running = running + column_sums[x];
+                }
+                dst[0] = running;
+                for (size_t x=kw; x < col_ct; ++x) {
+                    running = running + column_sums[x] - column_sums[x-kw];
+                    dst[x+1-kw] = running;
+                }
+            }
+        }
+        return out;
+    }
+};
+
+/* ============================
+    Free-function shorthands
+        Each of these uses a temporary `SlidingWindow`; keep a `SlidingWindow<T>` around instead to reuse its scratch buffers across calls.
+============================= */
+template <class T>
+Array2D<T>& window_min(const Array2D<T>& in, Array2D<T>& out, const size_t k, const window_axis axis) {
+    return SlidingWindow<T>().min(in, out, k, axis);
+}
+
+template <class T>
+Array2D<T>& window_max(const Array2D<T>& in, Array2D<T>& out, const size_t k, const window_axis axis) {
+    return SlidingWindow<T>().max(in, out, k, axis);
+}
+
+template <class T, class S = T>
+Array2D<S>& window_sum(const Array2D<T>& in, Array2D<S>& out, const size_t k, const window_axis axis) {
+    return SlidingWindow<T>().template sum<S>(in, out, k, axis);
+}
+
+template <class T>
+Array2D<T>& window_min(const Array2D<T>& in, Array2D<T>& out, const size_t kh, const size_t kw) {
+    return SlidingWindow<T>().min(in, out, kh, kw);
+}
+
+template <class T>
+Array2D<T>& window_max(const Array2D<T>& in, Array2D<T>& out, const size_t kh, const size_t kw) {
+    return SlidingWindow<T>().max(in, out, kh, kw);
+}
+
+template <class T, class S = T>
+Array2D<S>& window_sum(const Array2D<T>& in, Array2D<S>& out, const size_t kh, const size_t kw) {
+    return SlidingWindow<T>().template sum<S>(in, out, kh, kw);
+}
+
+};  // end namespace
+#endif
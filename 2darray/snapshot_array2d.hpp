@@ -0,0 +1,207 @@
+#ifndef YELLE_SNAPSHOT_ARRAY2D
+#define YELLE_SNAPSHOT_ARRAY2D
+
+#include "cow_array2d.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace yelle {
+
+// A 2D array that one writer updates while any number of readers keep reading it, without readers ever waiting on the writer (or on each other).
+// The writer changes a private draft (a `CowArray2D`), then `publish`es it: the draft is copied, which is O(1) and shares every unchanged row with the previous version, and the copy is swapped in with a single atomic store.
+// A reader calls `snapshot()` for a handle to whichever version is current, and reads it through the usual const `CowArray2D` methods (`safe_look`, `sum`, `foldl`, `to_string`, ...) for as long as it keeps the handle; that version never changes underneath it.
+// Old versions are freed by the writer once no handle can still refer to them (epoch-based reclamation): taking and dropping a handle is a few atomic operations on a slot of the reader's own, with no locks and no shared reference counts.
+// At most `MAX_READERS` handles can be held at once; beyond that, `snapshot()` spins until one is dropped.
+// Only one thread at a time may use the writer side (`draft`, `publish`, `update`, `reclaim`).
+template <class T, size_t MAX_READERS = 64>
+class SnapshotArray2D {
+protected:
+    // One published version of the array.
+    struct Version {
+        CowArray2D<T> array;
+        uint64_t number;
+    };
+
+    // Announced by a slot whose reader isn't reading.
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    // Each reader holds one slot while it has a handle, announcing there the epoch in which it started reading. Each slot sits on its own cache line.
+    struct alignas(64) ReaderSlot {
+        std::atomic<bool> claimed{false};
+        std::atomic<uint64_t> epoch{IDLE};
+    };
+
+    // reader-visible state
+    std::atomic<const Version*> current{nullptr};
+    std::atomic<uint64_t> global_epoch{1};
+    mutable ReaderSlot slots[MAX_READERS];
+
+    // writer-only state
+    CowArray2D<T> working;
+    uint64_t next_number = 0;
+    // versions replaced by later ones, with the epoch in which each was replaced: readers that started in a later epoch can't be holding them
+    std::vector<std::pair<uint64_t, const Version*>> retired;
+
+public:
+    // Handle to one published version, which stays valid (and unchanged) until the handle is dropped.
+    class Snapshot {
+    protected:
+        ReaderSlot* slot;
+        const Version* version;
+
+    public:
+        Snapshot(ReaderSlot* held_slot, const Version* held_version) : slot(held_slot), version(held_version) {
+            return;
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot(Snapshot&& other) noexcept : slot(other.slot), version(other.version) {
+            other.slot = nullptr;
+            return;
+        }
+        Snapshot& operator=(Snapshot&& other) noexcept {
+            if (this != &other) {
+                release();
+                slot = other.slot;
+                version = other.version;
+                other.slot = nullptr;
+            }
+            return *this;
+        }
+
+        ~Snapshot() {
+            release();
+        }
+
+        // Drops the handle early; the version may be freed at any point afterwards.
+        void release() noexcept {
+            if (slot != nullptr) {
+                // release: everything read through this handle happens before the writer can see the slot as idle and free the version
+                slot->epoch.store(IDLE, std::memory_order_release);
+                slot->claimed.store(false, std::memory_order_release);
+                slot = nullptr;
+            }
+        }
+
+        const CowArray2D<T>& operator*() const { return version->array; }
+        const CowArray2D<T>* operator->() const { return &version->array; }
+
+        // Number of the published version held, counting up from `0` for the initial contents.
+        uint64_t number() const { return version->number; }
+    };
+
+    // Creates a `rows` x `cols` array of `value`s, published as version `0`.
+    SnapshotArray2D(const size_t rows = 0, const size_t cols = 0, const T& value = T()) : working(rows, cols, value) {
+        publish();
+        return;
+    }
+
+    // Copies an `Array2D`, published as version `0`.
+    explicit SnapshotArray2D(const Array2D<T>& dense) : working(dense) {
+        publish();
+        return;
+    }
+
+    // Starts from the contents of a `CowArray2D` (sharing its rows), published as version `0`.
+    explicit SnapshotArray2D(const CowArray2D<T>& initial) : working(initial) {
+        publish();
+        return;
+    }
+
+    SnapshotArray2D(const SnapshotArray2D&) = delete;
+    SnapshotArray2D& operator=(const SnapshotArray2D&) = delete;
+
+    // Every `Snapshot` must have been dropped by now.
+    ~SnapshotArray2D() {
+        delete current.load(std::memory_order_relaxed);
+        for (const auto& entry : retired) {
+            delete entry.second;
+        }
+    }
+
+    /* ============================
+        Reader Side
+    ============================= */
+    // Returns a handle to the current version. Lock-free unless `MAX_READERS` handles are already held, in which case it spins until one is dropped.
+    Snapshot snapshot() const {
+        ReaderSlot* slot = claim_slot();
+        // announce the epoch first, then load the version: a writer that replaces this version afterwards retires it in this epoch or later, so it won't be freed while the slot holds this epoch
+        slot->epoch.store(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        const Version* version = current.load(std::memory_order_seq_cst);
+        return Snapshot(slot, version);
+    }
+
+    /* ============================
+        Writer Side
+    ============================= */
+    // The writer's private working copy, to change with any `CowArray2D` method (`set`, `map_inplace`, `insert_row`, `shift_vertical`, ...).
+    // Readers see none of the changes until `publish`. Rows shared with published versions are copied the first time they are written, so published versions never change.
+    CowArray2D<T>& draft() {
+        return working;
+    }
+
+    // Makes the draft's current contents the version that new snapshots see, returning its number; then frees whatever old versions no reader can still hold.
+    // Costs O(1) plus the freeing; no reader is ever blocked.
+    uint64_t publish() {
+        const Version* fresh = new Version{working, next_number++};
+        const Version* old = current.exchange(fresh, std::memory_order_seq_cst);
+        if (old != nullptr) {
+            retired.emplace_back(global_epoch.fetch_add(1, std::memory_order_seq_cst), old);
+        }
+        reclaim();
+        return fresh->number;
+    }
+
+    // Calls `func(draft())`, then `publish()`es the result and returns the new version's number.
+    template <class Func>
+    uint64_t update(Func&& func) {
+        func(working);
+        return publish();
+    }
+
+    // Frees every retired version that no reader can still hold, returning how many are left waiting on readers. Called by `publish`.
+    size_t reclaim() {
+        uint64_t oldest_reader = IDLE;
+        for (const ReaderSlot& slot : slots) {
+            oldest_reader = std::min(oldest_reader, slot.epoch.load(std::memory_order_seq_cst));
+        }
+        size_t kept = 0;
+        for (const auto& entry : retired) {
+            if (entry.first < oldest_reader) {
+                delete entry.second;
+            } else {
+                retired[kept++] = entry;
+            }
+        }
+        retired.resize(kept);
+        return kept;
+    }
+
+    // Number of the most recently published version.
+    uint64_t published_number() const {
+        return next_number - 1;
+    }
+
+protected:
+    // Finds a free reader slot and claims it, spinning if all of them are taken.
+    ReaderSlot* claim_slot() const {
+        // start the search at a per-thread position, so that readers on different threads mostly try different slots first
+        thread_local const size_t home = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (;;) {
+            for (size_t k=0; k < MAX_READERS; ++k) {
+                ReaderSlot& slot = slots[(home + k) % MAX_READERS];
+                bool expected = false;
+                if (!slot.claimed.load(std::memory_order_relaxed) && slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return &slot;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+
+};  // end namespace
+#endif
@@ -0,0 +1,321 @@
+#ifndef YELLE_SPARSE_ARRAY2D
+#define YELLE_SPARSE_ARRAY2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+namespace yelle {
+
+// Two-dimensional array of `T` in which almost every cell holds the same `background` value, so that only the other cells are stored.
+// Cells are added in coordinate (COO) form with `insert`, which is cheap; they are merged into compressed-sparse-row (CSR) form the next time the array is read.
+// Column-wise operations additionally build a compressed-sparse-column (CSC) index over the same values, which is kept until the array's structure changes.
+// Because of this lazy merging, even `const` methods may rearrange the internals, so a `SparseArray2D` shouldn't be read from several threads until `compress()` has been called.
+template <class T>
+class SparseArray2D {
+protected:
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+    T background = T();
+
+    // cells inserted since the last `compress`, in insertion order
+    struct Triplet {
+        size_t i;
+        size_t j;
+        T value;
+    };
+    mutable std::vector<Triplet> pending;
+
+    // CSR form: the stored cells of row `i` are at positions `[row_ptr[i], row_ptr[i+1])` of `col_idx` and `values`, sorted by column
+    mutable std::vector<size_t> row_ptr;
+    mutable std::vector<size_t> col_idx;
+    mutable std::vector<T> values;
+
+    // CSC index: the stored cells of column `j` are `values[csc_pos[k]]` for `k` in `[col_ptr[j], col_ptr[j+1])`, sorted by row (given by `row_idx[k]`)
+    mutable bool csc_valid = false;
+    mutable std::vector<size_t> col_ptr;
+    mutable std::vector<size_t> row_idx;
+    mutable std::vector<size_t> csc_pos;
+
+    // Merges `pending` into the CSR arrays. Where the same cell was inserted more than once, the latest value wins.
+    // Only `pending` is sorted; it's then merged with the already-sorted CSR rows in one linear pass, so this costs O(p log p + nnz + rows) for `p` pending cells.
+    void merge_pending() const {
+        if (pending.empty()) {
+            return;
+        }
+        // stable, so that later insertions of the same cell stay after earlier ones
+        std::stable_sort(pending.begin(), pending.end(), [](const Triplet& a, const Triplet& b) {
+            return (a.i != b.i ? a.i < b.i : a.j < b.j);
+        });
+
+        std::vector<size_t> merged_cols;
+        std::vector<T> merged_values;
+        merged_cols.reserve(values.size() + pending.size());
+        merged_values.reserve(values.size() + pending.size());
+        size_t p = 0;
+        size_t k = 0;
+        for (size_t i=0; i < row_ct; ++i) {
+            const size_t k_end = row_ptr[i+1];
+            while (k < k_end || (p < pending.size() && pending[p].i == i)) {
+                if (p < pending.size() && pending[p].i == i && (k == k_end || pending[p].j <= col_idx[k])) {
+                    // the last insertion of this cell wins, over both earlier ones and the stored value
+                    size_t last = p;
+                    while (last+1 < pending.size() && pending[last+1].i == i && pending[last+1].j == pending[p].j) {
+                        ++last;
+                    }
+                    if (k < k_end && col_idx[k] == pending[p].j) {
+                        ++k;
+                    }
+                    merged_cols.push_back(pending[last].j);
+                    merged_values.push_back(std::move(pending[last].value));
+                    p = last + 1;
+                } else {
+                    merged_cols.push_back(col_idx[k]);
+                    merged_values.push_back(std::move(values[k]));
+                    ++k;
+                }
+            }
+            row_ptr[i+1] = merged_cols.size();
+        }
+        pending.clear();
+        col_idx.swap(merged_cols);
+        values.swap(merged_values);
+        csc_valid = false;
+    }
+
+    // Builds the CSC index from the CSR arrays, by counting sort on the column.
+    void build_csc() const {
+        merge_pending();
+        if (csc_valid) {
+            return;
+        }
+        col_ptr.assign(col_ct + 1, 0);
+        for (const size_t j : col_idx) {
+            col_ptr[j+1]++;
+        }
+        for (size_t j=0; j < col_ct; ++j) {
+            col_ptr[j+1] += col_ptr[j];
+        }
+        row_idx.resize(values.size());
+        csc_pos.resize(values.size());
+        std::vector<size_t> next(col_ptr.begin(), col_ptr.end() - 1);
+        // walking the rows in order leaves each column's entries sorted by row
+        for (size_t i=0; i < row_ct; ++i) {
+            for (size_t k=row_ptr[i]; k < row_ptr[i+1]; ++k) {
+                const size_t dest = next[col_idx[k]]++;
+                row_idx[dest] = i;
+                csc_pos[dest] = k;
+            }
+        }
+        csc_valid = true;
+    }
+
+    // `background` repeated `count` times, summed. Requires `T * T -> T` and conversion from `size_t` to `T`.
+    T background_sum(const size_t count) const {
+        return (count == 0 ? T() : background * static_cast<T>(count));
+    }
+
+public:
+    // Default constructor: an empty `0` x `0` array.
+    SparseArray2D() : row_ptr(1, 0) {
+        return;
+    }
+
+    // Creates a `rows` x `cols` array where every cell holds `default_value`.
+    SparseArray2D(const size_t rows, const size_t cols, const T& default_value = T())
+    : row_ct(rows), col_ct(cols), background(default_value), row_ptr(rows + 1, 0) {
+        return;
+    }
+
+    // Converts a dense `Array2D` into a sparse one, storing only the cells that aren't equal to `default_value`. Requires `operator==` on `T`.
+    SparseArray2D(const Array2D<T>& dense, const T& default_value)
+    : row_ct(dense.rowCount()), col_ct(dense.colCount()), background(default_value), row_ptr(dense.rowCount() + 1, 0) {
+        for (size_t i=0; i < row_ct; ++i) {
+            const auto& row = dense[i];
+            for (size_t j=0; j < col_ct; ++j) {
+                if (!(row[j] == background)) {
+                    col_idx.push_back(j);
+                    values.push_back(row[j]);
+                }
+            }
+            row_ptr[i+1] = values.size();
+        }
+        return;
+    }
+
+    /* ============================
+        Building
+    ============================= */
+    // Sets the cell at `[i,j]` to `value`. This is O(1); the cell is merged into the compressed form on the next read.
+    // Will throw a `std::out_of_range` if `[i,j]` is outside the array.
+    SparseArray2D& insert(const size_t i, const size_t j, const T& value) {
+        if (i >= row_ct || j >= col_ct) {
+            fprintf(stderr, "Tried to insert at [%zu,%zu] in a %zux%zu sparse array!\n", i, j, row_ct, col_ct);
+            throw std::out_of_range("tried to insert outside of sparse array");
+        }
+        pending.push_back(Triplet{i, j, value});
+        return *this;
+    }
+
+    // Merges all cells inserted since the last read into the compressed form. Reads do this automatically, but calling it up front makes later `const` reads safe to share between threads.
+    SparseArray2D& compress() {
+        merge_pending();
+        return *this;
+    }
+
+    /* ============================
+        Attributes & Element Access
+    ============================= */
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+    size_t size() const { return row_ct * col_ct; }
+
+    // The value of every cell that isn't stored explicitly.
+    const T& default_value() const {
+        return background;
+    }
+
+    // Number of explicitly stored cells.
+    size_t stored_count() const {
+        merge_pending();
+        return values.size();
+    }
+
+    // Returns a `std::optional` copy of the element at `[i,j]` (which is the default value, unless the cell was stored). If there is no element at `[i,j]`, then returns a null optional.
+    // Not `noexcept`, since it first merges any pending insertions, which allocates.
+    std::optional<T> safe_look(const size_t i, const size_t j) const {
+        if (i >= row_ct || j >= col_ct) {
+            return std::optional<T>();
+        }
+        merge_pending();
+        const auto first = col_idx.begin() + row_ptr[i];
+        const auto last = col_idx.begin() + row_ptr[i+1];
+        const auto found = std::lower_bound(first, last, j);
+        if (found != last && *found == j) {
+            return std::optional<T>(values[found - col_idx.begin()]);
+        }
+        return std::optional<T>(background);
+    }
+
+    // Returns a copy of the element at `[i,j]`, throwing a `std::out_of_range` if there is no such element.
+    T at(const size_t i, const size_t j) const {
+        std::optional<T> found = safe_look(i, j);
+        if (!found) {
+            throw std::out_of_range("tried to access nonexistent row or column of sparse array");
+        }
+        return *found;
+    }
+
+    /* ============================
+        Calculations
+    ============================= */
+    // Map a unary function of type `T -> T` in-place onto every stored cell. Cells holding the default value are left alone.
+    SparseArray2D& map_inplace(const std::function<T(T)>& func) {
+        merge_pending();
+        for (T& value : values) {
+            value = func(value);
+        }
+        return *this;
+    }
+
+    // Sum of all elements, including the default-valued ones. Requires `T + T -> T`, `T * T -> T`, and conversion from `size_t`.
+    T sum() const {
+        merge_pending();
+        T total = background_sum(size() - values.size());
+        for (const T& value : values) {
+            total = total + value;
+        }
+        return total;
+    }
+
+    // Sum of all elements in column `column_j`, including the default-valued ones. Uses the CSC index, so costs O(stored cells in the column) once it's built.
+    // Will throw a `std::out_of_range` if the column doesn't exist.
+    T sum_col(const size_t column_j) const {
+        if (column_j >= col_ct) {
+            throw std::out_of_range("cannot use sum_col on too high of column index");
+        }
+        build_csc();
+        T total = background_sum(row_ct - (col_ptr[column_j+1] - col_ptr[column_j]));
+        for (size_t k=col_ptr[column_j]; k < col_ptr[column_j+1]; ++k) {
+            total = total + values[csc_pos[k]];
+        }
+        return total;
+    }
+
+    // Transposes the array, moving the element at `(i,j)` to `(j,i)`. This is O(stored cells): the CSC form of the array is exactly the CSR form of its transpose.
+    SparseArray2D& transpose() {
+        build_csc();
+        std::vector<T> new_values;
+        new_values.reserve(values.size());
+        for (const size_t k : csc_pos) {
+            new_values.push_back(std::move(values[k]));
+        }
+        values.swap(new_values);
+        row_ptr.swap(col_ptr);
+        col_idx.swap(row_idx);
+        std::swap(row_ct, col_ct);
+        csc_valid = false;
+        return *this;
+    }
+
+    // Sparse-times-dense matrix product, `(*this) * dense`, giving a dense `rowCount()` x `dense.colCount()` array.
+    // Only stored cells are multiplied out; a nonzero default value is accounted for by adding `default * (column sums of dense)` to every row.
+    // Requires `T + T -> T`, `T - T -> T`, `T * T -> T`, and that `T()` be the additive identity. Will throw a `std::length_error` if `dense.rowCount() != colCount()`.
+    Array2D<T> multiply(const Array2D<T>& dense) const {
+        if (dense.rowCount() != col_ct) {
+            fprintf(stderr, "Tried to multiply a %zux%zu sparse array by a %zux%zu array!\n", row_ct, col_ct, dense.rowCount(), dense.colCount());
+            throw std::length_error("incompatible dimensions for matrix multiplication");
+        }
+        merge_pending();
+        const size_t out_cols = dense.colCount();
+
+        // what each row would be if it held nothing but the default value, corrected below for the stored cells
+        std::vector<T> base(out_cols, T());
+        for (size_t j=0; j < col_ct; ++j) {
+            const auto& dense_row = dense[j];
+            for (size_t k=0; k < out_cols; ++k) {
+                base[k] = base[k] + dense_row[k];
+            }
+        }
+        for (size_t k=0; k < out_cols; ++k) {
+            base[k] = background * base[k];
+        }
+
+        std::vector<std::vector<T>> result;
+        result.reserve(row_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            std::vector<T> out_row(base);
+            for (size_t n=row_ptr[i]; n < row_ptr[i+1]; ++n) {
+                const auto& dense_row = dense[col_idx[n]];
+                // stored cells replace the default value that `base` assumed
+                const T weight = values[n] - background;
+                for (size_t k=0; k < out_cols; ++k) {
+                    out_row[k] = out_row[k] + weight * dense_row[k];
+                }
+            }
+            result.push_back(std::move(out_row));
+        }
+        return Array2D<T>(std::move(result));
+    }
+
+    /* ============================
+        Conversion
+    ============================= */
+    // Creates a dense `Array2D` with the same contents.
+    Array2D<T> to_array() const {
+        merge_pending();
+        Array2D<T> dense;
+        dense.fill(row_ct, col_ct, background);
+        for (size_t i=0; i < row_ct; ++i) {
+            auto&& row = dense[i];
+            for (size_t k=row_ptr[i]; k < row_ptr[i+1]; ++k) {
+                row[col_idx[k]] = values[k];
+            }
+        }
+        return dense;
+    }
+};
+
+};  // end namespace
+#endif
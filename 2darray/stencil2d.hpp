@@ -0,0 +1,234 @@
+#ifndef YELLE_STENCIL2D
+#define YELLE_STENCIL2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <array>
+#include <thread>
+
+namespace yelle {
+
+// How a stencil reads neighbors that fall outside the grid.
+// `CLAMP` repeats the nearest edge cell, `WRAP` loops around to the opposite edge, and `CONSTANT` reads a fixed value.
+enum class border_policy { CLAMP, WRAP, CONSTANT };
+
+// Runs repeated stencil updates (cellular automata, diffusion, convolutions) over a grid.
+// The grid is copied once into two flat row-major buffers; each generation reads from one and writes into the other, then the two are swapped, so no per-step allocation takes place.
+// Interior cells (whose whole neighborhood is in-bounds) are processed without any bounds checks; only the `RADIUS`-wide halo along the edges goes through the border policy.
+template <class T>
+class Stencil2D {
+protected:
+    std::vector<T> front;   // current generation
+    std::vector<T> back;    // scratch buffer that the next generation is written into
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+    border_policy policy = border_policy::CLAMP;
+    T constant_val = T();
+    size_t thread_ct = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    // Neighborhood accessor for interior cells: `nb(di,dj)` reads straight from the buffer with no checks.
+    struct InteriorView {
+        const T* center;
+        size_t stride;
+        size_t i;
+        size_t j;
+
+        const T& operator()(const long di, const long dj) const {
+            return center[di * static_cast<long>(stride) + dj];
+        }
+        size_t row() const { return i; }
+        size_t col() const { return j; }
+    };
+
+    // Neighborhood accessor for halo cells: `nb(di,dj)` resolves out-of-range neighbors through the border policy.
+    struct BorderView {
+        const Stencil2D* owner;
+        const T* data;
+        size_t i;
+        size_t j;
+
+        const T& operator()(const long di, const long dj) const {
+            long ni = static_cast<long>(i) + di;
+            long nj = static_cast<long>(j) + dj;
+            const long rows = static_cast<long>(owner->row_ct);
+            const long cols = static_cast<long>(owner->col_ct);
+            if (ni < 0 || ni >= rows || nj < 0 || nj >= cols) {
+                switch (owner->policy) {
+                    case border_policy::CLAMP:
+                        ni = std::clamp<long>(ni, 0, rows - 1);
+                        nj = std::clamp<long>(nj, 0, cols - 1);
+                        break;
+                    case border_policy::WRAP:
+                        ni = ((ni % rows) + rows) % rows;
+                        nj = ((nj % cols) + cols) % cols;
+                        break;
+                    case border_policy::CONSTANT:
+                        return owner->constant_val;
+                }
+            }
+            return data[static_cast<size_t>(ni) * owner->col_ct + static_cast<size_t>(nj)];
+        }
+        size_t row() const { return i; }
+        size_t col() const { return j; }
+    };
+
+    // Computes rows `[row_start, row_past_end)` of the next generation into `back`.
+    template <long RADIUS, class Func>
+    void step_rows(Func& func, const size_t row_start, const size_t row_past_end) {
+        const T* src = front.data();
+        T* dst = back.data();
+        const size_t radius = static_cast<size_t>(RADIUS);
+        // columns `[col_lo, col_hi)` are interior for any interior row
+        const size_t col_lo = std::min(radius, col_ct);
+        const size_t col_hi = std::max(col_lo, col_ct - std::min(radius, col_ct));
+
+        for (size_t i = row_start; i < row_past_end; ++i) {
+            const bool border_row = (i < radius || i + radius >= row_ct);
+            if (border_row) {
+                for (size_t j=0; j < col_ct; ++j) {
+                    dst[i*col_ct + j] = func(BorderView{this, src, i, j});
+                }
+                continue;
+            }
+            for (size_t j=0; j < col_lo; ++j) {
+                dst[i*col_ct + j] = func(BorderView{this, src, i, j});
+            }
+            // check-free interior loop
+            const T* src_row = src + i*col_ct;
+            T* dst_row = dst + i*col_ct;
+            for (size_t j=col_lo; j < col_hi; ++j) {
+                dst_row[j] = func(InteriorView{src_row + j, col_ct, i, j});
+            }
+            for (size_t j=col_hi; j < col_ct; ++j) {
+                dst[i*col_ct + j] = func(BorderView{this, src, i, j});
+            }
+        }
+    }
+
+public:
+    // Default constructor: an empty grid. As with every constructor, the thread count defaults to the hardware's concurrency.
+    Stencil2D() {
+        return;
+    }
+
+    // Copies the contents of `grid` into the working buffers. Border policy defaults to `CLAMP`, and the thread count to the hardware's concurrency.
+    explicit Stencil2D(const Array2D<T>& grid, const border_policy border = border_policy::CLAMP, const T& constant = T())
+    : policy(border), constant_val(constant) {
+        load(grid);
+        return;
+    }
+
+    // Replaces the current generation with a copy of `grid`, reusing the existing buffers where possible.
+    Stencil2D& load(const Array2D<T>& grid) {
+        row_ct = grid.rowCount();
+        col_ct = grid.colCount();
+        front.clear();
+        front.reserve(row_ct * col_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            for (size_t j=0; j < col_ct; ++j) {
+                front.push_back(grid[i][j]);
+            }
+        }
+        back.resize(front.size());
+        return *this;
+    }
+
+    // Sets how out-of-range neighbors are read. `constant` is only used with `border_policy::CONSTANT`.
+    Stencil2D& set_border(const border_policy border, const T& constant = T()) {
+        policy = border;
+        constant_val = constant;
+        return *this;
+    }
+
+    // Sets the number of threads that each generation is split across (in horizontal strips). `0` is treated as `1`.
+    Stencil2D& set_threads(const size_t threads) {
+        thread_ct = std::max<size_t>(1, threads);
+        return *this;
+    }
+
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+
+    // Read-only access to the current generation at `[i,j]`, without bounds checking.
+    const T& look(const size_t i, const size_t j) const {
+        return front[i*col_ct + j];
+    }
+
+    // Advances the grid by one generation.
+    // `func` is called once per cell with a neighborhood accessor `nb`, where `nb(di,dj)` is the current value at `[i+di, j+dj]` for `|di|,|dj| <= RADIUS`, and `nb.row()`, `nb.col()` give the cell's own position.
+    // Because interior and halo cells pass differently-typed accessors, `func` should take its argument as `auto` (e.g. a generic lambda).
+    // Reading beyond `RADIUS` is undefined behaviour for interior cells.
+    template <long RADIUS, class Func>
+    Stencil2D& step(Func func) {
+        static_assert(RADIUS >= 0, "stencil radius must be non-negative");
+        if (row_ct == 0 || col_ct == 0) {
+            return *this;
+        }
+        // don't bother spinning up threads for grids that are too small to benefit
+        const size_t min_rows_per_thread = 64;
+        const size_t workers = std::min(thread_ct, std::max<size_t>(1, row_ct / min_rows_per_thread));
+        if (workers <= 1) {
+            step_rows<RADIUS>(func, 0, row_ct);
+        } else {
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+            const size_t strip = (row_ct + workers - 1) / workers;
+            for (size_t w=1; w < workers; ++w) {
+                const size_t r0 = std::min(row_ct, w * strip);
+                const size_t r1 = std::min(row_ct, r0 + strip);
+                // each worker gets its own copy of `func`, so that stateful functors are not shared between threads
+                pool.emplace_back([this, func, r0, r1]() mutable {
+                    step_rows<RADIUS>(func, r0, r1);
+                });
+            }
+            step_rows<RADIUS>(func, 0, std::min(row_ct, strip));
+            for (std::thread& t : pool) {
+                t.join();
+            }
+        }
+        front.swap(back);
+        return *this;
+    }
+
+    // Advances the grid by `generations` generations of `step<RADIUS>(func)`.
+    template <long RADIUS, class Func>
+    Stencil2D& run(const size_t generations, Func func) {
+        for (size_t g=0; g < generations; ++g) {
+            step<RADIUS>(func);
+        }
+        return *this;
+    }
+
+    // Advances the grid by one generation of a weighted sum over the `N`x`N` neighborhood (`N` odd), where `kernel[a][b]` weighs the neighbor at `[i + a - N/2, j + b - N/2]`.
+    // Requires `T * K -> T` and `T + T -> T`.
+    template <size_t N, class K>
+    Stencil2D& convolve(const std::array<std::array<K, N>, N>& kernel) {
+        static_assert(N % 2 == 1, "convolution kernel must have odd side length");
+        constexpr long R = static_cast<long>(N / 2);
+        return step<R>([&kernel](const auto& nb) {
+            T total = T();
+            for (long a=0; a < static_cast<long>(N); ++a) {
+                for (long b=0; b < static_cast<long>(N); ++b) {
+                    total = total + nb(a - R, b - R) * kernel[a][b];
+                }
+            }
+            return total;
+        });
+    }
+
+    // Copies the current generation out into a new `Array2D`.
+    Array2D<T> to_array() const {
+        std::vector<std::vector<T>> rows;
+        rows.reserve(row_ct);
+        for (size_t i=0; i < row_ct; ++i) {
+            rows.emplace_back(front.begin() + i*col_ct, front.begin() + (i+1)*col_ct);
+        }
+        return Array2D<T>(std::move(rows));
+    }
+};
+
+};  // end namespace
+#endif
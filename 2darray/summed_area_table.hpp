@@ -0,0 +1,158 @@
+#ifndef YELLE_SUMMED_AREA_TABLE
+#define YELLE_SUMMED_AREA_TABLE
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <thread>
+
+namespace yelle {
+
+// Summed-area table (a.k.a. integral image) over an `Array2D<T>`, answering the sum of any sub-rectangle in O(1).
+// Sums are accumulated in type `S`, which defaults to `T` but can be made wider (e.g. `SummedAreaTable<char, long>`) to avoid overflow.
+// Requires `S + S -> S`, `S - S -> S`, conversion from `T` to `S`, and that `S()` be the additive identity.
+template <class T, class S = T>
+class SummedAreaTable {
+protected:
+    // `(row_ct+1) x (col_ct+1)` row-major table; entry `[i,j]` holds the sum of the grid over `[0,i) x [0,j)`, so row 0 and column 0 are all `S()`.
+    std::vector<S> table;
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+
+    S& entry(const size_t i, const size_t j) {
+        return table[i*(col_ct+1) + j];
+    }
+    const S& entry(const size_t i, const size_t j) const {
+        return table[i*(col_ct+1) + j];
+    }
+
+    // Runs `func(start, past_end)` over `[0, count)` split into `threads` contiguous chunks, one per thread.
+    template <class Func>
+    static void parallel_chunks(const size_t count, size_t threads, Func func) {
+        threads = std::max<size_t>(1, std::min(threads, count));
+        if (threads == 1) {
+            func(size_t(0), count);
+            return;
+        }
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        const size_t chunk = (count + threads - 1) / threads;
+        for (size_t t=1; t < threads; ++t) {
+            const size_t start = std::min(count, t * chunk);
+            const size_t past_end = std::min(count, start + chunk);
+            pool.emplace_back(func, start, past_end);
+        }
+        func(size_t(0), std::min(count, chunk));
+        for (std::thread& th : pool) {
+            th.join();
+        }
+    }
+
+public:
+    // Default constructor: a table over an empty grid.
+    SummedAreaTable() {
+        return;
+    }
+
+    // Builds the table from `grid`. See `build` regarding `threads`.
+    explicit SummedAreaTable(const Array2D<T>& grid, const size_t threads = 1) {
+        build(grid, threads);
+        return;
+    }
+
+    // (Re)builds the whole table from `grid` in one linear pass.
+    // With `threads > 1`, the pass is split in two parallel phases: prefix sums along each row (split by rows), then down each column (split by columns).
+    SummedAreaTable& build(const Array2D<T>& grid, const size_t threads = 1) {
+        row_ct = grid.rowCount();
+        col_ct = grid.colCount();
+        table.assign((row_ct+1) * (col_ct+1), S());
+
+        if (threads <= 1) {
+            // single pass: each entry only depends on the one above it and the running row sum
+            for (size_t i=0; i < row_ct; ++i) {
+                S running = S();
+                for (size_t j=0; j < col_ct; ++j) {
+                    running = running + static_cast<S>(grid[i][j]);
+                    entry(i+1, j+1) = entry(i, j+1) + running;
+                }
+            }
+            return *this;
+        }
+
+        // phase 1: horizontal prefix sums, rows are independent
+        parallel_chunks(row_ct, threads, [this, &grid](const size_t i_start, const size_t i_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                S running = S();
+                for (size_t j=0; j < col_ct; ++j) {
+                    running = running + static_cast<S>(grid[i][j]);
+                    entry(i+1, j+1) = running;
+                }
+            }
+        });
+        // phase 2: vertical prefix sums, columns are independent; walk row-by-row within each column block to stay cache-friendly
+        parallel_chunks(col_ct, threads, [this](const size_t j_start, const size_t j_past_end) {
+            for (size_t i=2; i <= row_ct; ++i) {
+                for (size_t j=j_start+1; j <= j_past_end; ++j) {
+                    entry(i, j) = entry(i, j) + entry(i-1, j);
+                }
+            }
+        });
+        return *this;
+    }
+
+    // Incrementally rebuilds the table after only the cells of `grid` in `[i_start, i_past_end) x [j_start, j_past_end)` have changed.
+    // Only the entries at or below-right of `[i_start, j_start]` depend on those cells, so only they are recomputed.
+    // Will throw a `std::length_error` if `grid` does not have the same dimensions as the table, or a `std::out_of_range` if the region does not fit in the grid.
+    SummedAreaTable& update(const Array2D<T>& grid, const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+        if (grid.rowCount() != row_ct || grid.colCount() != col_ct) {
+            fprintf(stderr, "Tried to update a %zux%zu summed-area table from a %zux%zu array!\n", row_ct, col_ct, grid.rowCount(), grid.colCount());
+            throw std::length_error("summed-area table and array have unequal dimensions");
+        }
+        if (i_past_end > row_ct || j_past_end > col_ct) {
+            fprintf(stderr, "Tried to update region [%zu,%zu)x[%zu,%zu) of a %zux%zu summed-area table!\n", i_start, i_past_end, j_start, j_past_end, row_ct, col_ct);
+            throw std::out_of_range("updated region outside of valid range");
+        }
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return *this;
+        }
+        for (size_t i=i_start; i < row_ct; ++i) {
+            // the running row sum restarts from what's already known left of the region
+            S running = entry(i+1, j_start) - entry(i, j_start);
+            for (size_t j=j_start; j < col_ct; ++j) {
+                running = running + static_cast<S>(grid[i][j]);
+                entry(i+1, j+1) = entry(i, j+1) + running;
+            }
+        }
+        return *this;
+    }
+
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+
+    // Returns the sum of the grid over the rectangle `[i_start, i_past_end) x [j_start, j_past_end)`, in O(1). Note that the `past_end` indices are excluded.
+    // Empty rectangles (`i_start >= i_past_end` or `j_start >= j_past_end`) sum to `S()`. No bounds checking is done; see `safe_rect_sum`.
+    S rect_sum(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) const {
+        if (i_start >= i_past_end || j_start >= j_past_end) {
+            return S();
+        }
+        return entry(i_past_end, j_past_end) - entry(i_start, j_past_end) - entry(i_past_end, j_start) + entry(i_start, j_start);
+    }
+
+    // Same as `rect_sum`, but returns a null optional if the rectangle does not fit in the grid.
+    std::optional<S> safe_rect_sum(const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) const noexcept {
+        if (i_past_end > row_ct || j_past_end > col_ct) {
+            return std::optional<S>();
+        }
+        return std::optional<S>(rect_sum(i_start, j_start, i_past_end, j_past_end));
+    }
+
+    // Returns the sum of the whole grid.
+    S total() const {
+        return entry(row_ct, col_ct);
+    }
+};
+
+};  // end namespace
+#endif
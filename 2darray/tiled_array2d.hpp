@@ -0,0 +1,321 @@
+#ifndef YELLE_TILED_ARRAY2D
+#define YELLE_TILED_ARRAY2D
+
+#ifndef YELLE_ARRAY2D_NO_DEMO
+#define YELLE_ARRAY2D_NO_DEMO
+#endif
+#include "array2d.cpp"
+
+#include <cstdint>
+
+namespace yelle {
+
+/* ============================
+    Layout Policies
+============================= */
+// A layout maps a logical `(i,j)` onto an offset in one flat buffer. Every layout provides:
+//   * a constructor from `(rows, cols)`, and a default constructor for the empty array
+//   * `storage_size()`, the length of the buffer (which may include padding)
+//   * `index(i,j)`, the offset of element `(i,j)`
+//   * `block_side`, the side of the square blocks that traversals should walk one at a time to stay within a few cache lines
+
+// Square `TILE` x `TILE` tiles, stored one after another in row-major order of tiles, each of them row-major inside.
+// The grid is padded out to a whole number of tiles. `TILE` must be a power of two.
+template <size_t TILE = 32>
+class tile_layout {
+    static_assert(TILE > 0 && (TILE & (TILE - 1)) == 0, "tile side must be a power of two");
+protected:
+    size_t tiles_down = 0;
+    size_t tiles_across = 0;
+
+public:
+    static constexpr size_t block_side = TILE;
+
+    tile_layout() {
+        return;
+    }
+
+    tile_layout(const size_t rows, const size_t cols)
+    : tiles_down((rows + TILE - 1) / TILE), tiles_across((cols + TILE - 1) / TILE) {
+        return;
+    }
+
+    size_t storage_size() const {
+        return tiles_down * tiles_across * TILE * TILE;
+    }
+
+    size_t index(const size_t i, const size_t j) const {
+        return ((i / TILE) * tiles_across + (j / TILE)) * (TILE * TILE) + (i % TILE) * TILE + (j % TILE);
+    }
+};
+
+// Morton (Z-order) layout: the bits of `i` and `j` are interleaved, so that every aligned `2^k` x `2^k` square is contiguous at every scale.
+// Each dimension is padded to a power of two; where one is longer than the other, its leftover high bits are placed above the interleaved ones, which makes the long dimension a row of Z-ordered squares.
+class morton_layout {
+protected:
+    unsigned shared_bits = 0;
+    unsigned row_bits = 0;
+    unsigned col_bits = 0;
+
+    // number of bits needed to index `[0, n)`
+    static unsigned bits_for(size_t n) {
+        unsigned bits = 0;
+        while ((size_t(1) << bits) < n) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    // spreads the low 32 bits of `x` out to the even bit positions
+    static uint64_t spread_bits(uint64_t x) {
+        x &= 0x00000000FFFFFFFFull;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x << 8))  & 0x00FF00FF00FF00FFull;
+        x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x << 2))  & 0x3333333333333333ull;
+        x = (x | (x << 1))  & 0x5555555555555555ull;
+        return x;
+    }
+
+public:
+    static constexpr size_t block_side = 16;
+
+    morton_layout() {
+        return;
+    }
+
+    morton_layout(const size_t rows, const size_t cols)
+    : row_bits(bits_for(rows)), col_bits(bits_for(cols)) {
+        shared_bits = std::min(row_bits, col_bits);
+        return;
+    }
+
+    size_t storage_size() const {
+        return size_t(1) << (row_bits + col_bits);
+    }
+
+    size_t index(const size_t i, const size_t j) const {
+        const size_t low_mask = (size_t(1) << shared_bits) - 1;
+        const size_t interleaved = static_cast<size_t>(spread_bits(j & low_mask) | (spread_bits(i & low_mask) << 1));
+        // at most one of these is nonzero: the high bits of whichever dimension is longer
+        const size_t leftover = (i >> shared_bits) | (j >> shared_bits);
+        return interleaved | (leftover << (2 * shared_bits));
+    }
+};
+
+/* ============================
+    Tiled Array
+============================= */
+// Two-dimensional array of `T` kept in one flat buffer whose order is chosen by `Layout` (`tile_layout<TILE>` or `morton_layout`), rather than row by row.
+// Addressing is the same `(i,j)` as for `Array2D`, but elements that are close in both directions are close in memory, so that column walks, transposes and neighborhood queries don't stride across the whole array.
+// Whole-array operations (`map`, `transpose`, and the reductions) walk the array one `Layout::block_side`-square block at a time.
+template <class T, class Layout = tile_layout<>>
+class TiledArray2D {
+    template <class, class> friend class TiledArray2D;
+protected:
+    std::vector<T> data;    // includes the layout's padding, which holds `T()`
+    Layout layout;
+    size_t row_ct = 0;
+    size_t col_ct = 0;
+
+    // Calls `func(i_start, j_start, i_past_end, j_past_end)` on each block of the array in turn.
+    template <class Func>
+    void for_each_block(Func func) const {
+        const size_t side = Layout::block_side;
+        for (size_t bi=0; bi < row_ct; bi += side) {
+            const size_t bi_past_end = std::min(row_ct, bi + side);
+            for (size_t bj=0; bj < col_ct; bj += side) {
+                func(bi, bj, bi_past_end, std::min(col_ct, bj + side));
+            }
+        }
+    }
+
+public:
+    // Default constructor: an empty `0` x `0` array.
+    TiledArray2D() {
+        return;
+    }
+
+    // Creates a `rows` x `cols` array of `value`s.
+    TiledArray2D(const size_t rows, const size_t cols, const T& value = T())
+    : layout(rows, cols), row_ct(rows), col_ct(cols) {
+        data.assign(layout.storage_size(), T());
+        for_each_block([this, &value](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    data[layout.index(i, j)] = value;
+                }
+            }
+        });
+        return;
+    }
+
+    // Copies an `Array2D` into the tiled layout.
+    explicit TiledArray2D(const Array2D<T>& dense)
+    : layout(dense.rowCount(), dense.colCount()), row_ct(dense.rowCount()), col_ct(dense.colCount()) {
+        data.assign(layout.storage_size(), T());
+        for_each_block([this, &dense](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                const auto& row = dense[i];
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    data[layout.index(i, j)] = row[j];
+                }
+            }
+        });
+        return;
+    }
+
+    /* ============================
+        Attributes & Element Access
+    ============================= */
+    size_t rowCount() const { return row_ct; }
+    size_t colCount() const { return col_ct; }
+    size_t size() const { return row_ct * col_ct; }
+    bool empty() const { return row_ct == 0 || col_ct == 0; }
+
+    // Direct access to the element at `(i,j)`, without bounds checking.
+    T& operator()(const size_t i, const size_t j) {
+        return data[layout.index(i, j)];
+    }
+    const T& operator()(const size_t i, const size_t j) const {
+        return data[layout.index(i, j)];
+    }
+
+    // Access to the element at `(i,j)`, throwing a `std::out_of_range` if there is no such element.
+    T& at(const size_t i, const size_t j) {
+        if (i >= row_ct || j >= col_ct) {
+            throw std::out_of_range("tried to access nonexistent row or column of tiled array");
+        }
+        return data[layout.index(i, j)];
+    }
+    const T& at(const size_t i, const size_t j) const {
+        if (i >= row_ct || j >= col_ct) {
+            throw std::out_of_range("tried to access nonexistent row or column of tiled array");
+        }
+        return data[layout.index(i, j)];
+    }
+
+    // Returns a `std::optional` copy of the element at `(i,j)`. If there is no element at `(i,j)`, then returns a null optional.
+    std::optional<T> safe_look(const size_t i, const size_t j) const noexcept {
+        if (i >= row_ct || j >= col_ct) {
+            return std::optional<T>();
+        }
+        return std::optional<T>(data[layout.index(i, j)]);
+    }
+
+    /* ============================
+        Calculations
+    ============================= */
+    // Map a unary function onto this array, returning a new array (with the same layout) and leaving the original unchanged.
+    template <class S>
+    TiledArray2D<S, Layout> map(const std::function<S(T)>& func) const {
+        TiledArray2D<S, Layout> out;
+        out.layout = layout;
+        out.row_ct = row_ct;
+        out.col_ct = col_ct;
+        out.data.assign(data.size(), S());
+        for_each_block([this, &out, &func](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    const size_t k = layout.index(i, j);
+                    out.data[k] = func(data[k]);
+                }
+            }
+        });
+        return out;
+    }
+
+    // Map a unary function of type `T -> T` onto this array, changing each value in-place.
+    TiledArray2D& map_inplace(const std::function<T(T)>& func) {
+        for_each_block([this, &func](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    T& elem = data[layout.index(i, j)];
+                    elem = func(elem);
+                }
+            }
+        });
+        return *this;
+    }
+
+    // Transposes the array, moving the element at `(i,j)` to `(j,i)`.
+    // Each source block lands in a single destination block, so both sides of the copy stay within a few cache lines at a time.
+    TiledArray2D& transpose() {
+        Layout flipped(col_ct, row_ct);
+        std::vector<T> flipped_data(flipped.storage_size(), T());
+        for_each_block([this, &flipped, &flipped_data](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    flipped_data[flipped.index(j, i)] = std::move(data[layout.index(i, j)]);
+                }
+            }
+        });
+        data.swap(flipped_data);
+        layout = flipped;
+        std::swap(row_ct, col_ct);
+        return *this;
+    }
+
+    // Folds `func` over every element, block by block. The order in which elements are visited is unspecified, so `func` should be associative and commutative (like `+` or `max`).
+    template <class S>
+    S reduce(const std::function<S(S,T)>& func, S accumulator) const {
+        for_each_block([this, &func, &accumulator](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    accumulator = func(accumulator, data[layout.index(i, j)]);
+                }
+            }
+        });
+        return accumulator;
+    }
+
+    // Sums all elements in the array. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum() const {
+        std::plus<T> T_addition;
+        return reduce<T>(T_addition, T());
+    }
+
+    // Sums all elements in row `row_i`. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    T sum_row(const size_t row_i) const {
+        if (row_i >= row_ct) {
+            throw std::out_of_range("cannot use sum_row on too high of row index");
+        }
+        T total = T();
+        for (size_t j=0; j < col_ct; ++j) {
+            total = total + data[layout.index(row_i, j)];
+        }
+        return total;
+    }
+
+    // Sums all elements in column `column_j`. Requires that `operator+` be defined for `T + T -> T`, and that `T()` be the additive identity.
+    // Unlike in a row-major array, consecutive elements of the column share a tile (or Z-ordered square), and hence mostly the same pages.
+    T sum_col(const size_t column_j) const {
+        if (column_j >= col_ct) {
+            throw std::out_of_range("cannot use sum_col on too high of column index");
+        }
+        T total = T();
+        for (size_t i=0; i < row_ct; ++i) {
+            total = total + data[layout.index(i, column_j)];
+        }
+        return total;
+    }
+
+    /* ============================
+        Conversion
+    ============================= */
+    // Copies the contents out into a row-major `Array2D`.
+    Array2D<T> to_array() const {
+        std::vector<std::vector<T>> rows(row_ct, std::vector<T>(col_ct));
+        for_each_block([this, &rows](const size_t i_start, const size_t j_start, const size_t i_past_end, const size_t j_past_end) {
+            for (size_t i=i_start; i < i_past_end; ++i) {
+                for (size_t j=j_start; j < j_past_end; ++j) {
+                    rows[i][j] = data[layout.index(i, j)];
+                }
+            }
+        });
+        return Array2D<T>(std::move(rows));
+    }
+};
+
+};  // end namespace
+#endif